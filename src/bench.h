@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Bench {
+    constexpr int DEFAULT_DEPTH = 8;
+    constexpr size_t DEFAULT_HASH_MB = 16;
+    constexpr int DEFAULT_THREADS = 1;
+
+    // Searches a fixed set of positions to depth with a freshly cleared TT and
+    // prints the total node count, elapsed time and NPS.
+    // With one thread the node count is deterministic and works as a functional
+    // signature: any change to search, eval or move ordering changes it.
+    // The Hash size and thread count are restored afterwards. Returns the node count
+    uint64_t run(int depth, size_t hashMB, int threads, std::ostream &os);
+}
@@ -2,9 +2,12 @@
 #include "move.h"
 #include "zobrist.h"
 #include "magic.h"
+#include "eval/psqt.h"
 #include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <iostream>
+#include <sstream>
 
 void Board::clear() // clear function (no board)
 {
@@ -27,10 +30,24 @@ void Board::clear() // clear function (no board)
     blackCanQueenside = false;
     enPassantTarget = -1;
     sideToMove = Color::WHITE;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
     
     // Initialize hash
     hashKey = 0ULL;
+    pawnKey = Zobrist::noPawnsKey;
+    materialKey = 0ULL;
     hashHistory.clear();
+    
+    psqMg = 0;
+    psqEg = 0;
+    phase = 0;
+    nonPawnMaterial[WHITE] = 0;
+    nonPawnMaterial[BLACK] = 0;
+    
+    accumulatorIndex = 0;
+    accumulatorOverflow = 0;
+    accumulators[0].computed = false;
 }
 
 void Board::initStartPosition() // initializing the piece position using a bitboard
@@ -77,6 +94,150 @@ void Board::initStartPosition() // initializing the piece position using a bitbo
     
     // Compute initial hash
     hashKey = Zobrist::computeHash(*this);
+    pawnKey = Zobrist::computePawnHash(*this);
+    materialKey = Zobrist::computeMaterialHash(*this);
+    computeEvalTerms();
+}
+
+bool Board::setFromFEN(const std::string &fen) {
+    clear();
+
+    std::istringstream is(fen);
+    std::string placement, side, castling, enPassant;
+    if (!(is >> placement >> side)) {
+        return false;
+    }
+    // The remaining fields may be missing in shortened FENs
+    if (!(is >> castling)) castling = "-";
+    if (!(is >> enPassant)) enPassant = "-";
+    if (!(is >> halfmoveClock)) halfmoveClock = 0;
+    if (!(is >> fullmoveNumber) || fullmoveNumber < 1) fullmoveNumber = 1;
+
+    // Piece placement, from rank 8 down to rank 1
+    int row = 7;
+    int column = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (column != 8) {
+                clear();
+                return false;
+            }
+            row--;
+            column = 0;
+        } else if (c >= '1' && c <= '8') {
+            column += c - '0';
+        } else {
+            PieceType pt;
+            switch (std::tolower(c)) {
+            case 'p': pt = PAWN; break;
+            case 'n': pt = KNIGHT; break;
+            case 'b': pt = BISHOP; break;
+            case 'r': pt = ROOK; break;
+            case 'q': pt = QUEEN; break;
+            case 'k': pt = KING; break;
+            default: clear(); return false;
+            }
+            if (row < 0 || column > 7) {
+                clear();
+                return false;
+            }
+            Color color = std::isupper(c) ? WHITE : BLACK;
+            bitboards[color][pt] |= bit(column, row);
+            column++;
+        }
+        if (column > 8) {
+            clear();
+            return false;
+        }
+    }
+    if (row != 0 || column != 8) {
+        clear();
+        return false;
+    }
+
+    // Side to move
+    if (side == "w") {
+        sideToMove = WHITE;
+    } else if (side == "b") {
+        sideToMove = BLACK;
+    } else {
+        clear();
+        return false;
+    }
+
+    // Castling rights
+    for (char c : castling) {
+        switch (c) {
+        case 'K': whiteCanKingside = true; break;
+        case 'Q': whiteCanQueenside = true; break;
+        case 'k': blackCanKingside = true; break;
+        case 'q': blackCanQueenside = true; break;
+        default: break;
+        }
+    }
+
+    // En passant target square
+    if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h'
+        && enPassant[1] >= '1' && enPassant[1] <= '8') {
+        enPassantTarget = position(enPassant[0] - 'a', enPassant[1] - '1');
+    }
+
+    updateCachedBitboards();
+    hashKey = Zobrist::computeHash(*this);
+    pawnKey = Zobrist::computePawnHash(*this);
+    materialKey = Zobrist::computeMaterialHash(*this);
+    computeEvalTerms();
+    return true;
+}
+
+std::string Board::toFEN() const {
+    static const char pieceChars[7] = {' ', 'p', 'n', 'b', 'r', 'q', 'k'};
+    std::string fen;
+
+    // Piece placement, from rank 8 down to rank 1
+    for (int row = 7; row >= 0; --row) {
+        int empty = 0;
+        for (int column = 0; column < 8; ++column) {
+            int sq = position(column, row);
+            PieceType pt = pieceAt(sq);
+            if (pt == PieceType::EMPTY) {
+                empty++;
+                continue;
+            }
+            if (empty) {
+                fen += static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            char c = pieceChars[pt];
+            fen += (colorAt(sq) == WHITE) ? static_cast<char>(std::toupper(c)) : c;
+        }
+        if (empty) {
+            fen += static_cast<char>('0' + empty);
+        }
+        if (row > 0) {
+            fen += '/';
+        }
+    }
+
+    fen += (sideToMove == WHITE) ? " w " : " b ";
+
+    std::string castling;
+    if (whiteCanKingside) castling += 'K';
+    if (whiteCanQueenside) castling += 'Q';
+    if (blackCanKingside) castling += 'k';
+    if (blackCanQueenside) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+
+    fen += ' ';
+    if (enPassantTarget != -1) {
+        fen += static_cast<char>('a' + column(enPassantTarget));
+        fen += static_cast<char>('1' + row(enPassantTarget));
+    } else {
+        fen += '-';
+    }
+
+    fen += ' ' + std::to_string(halfmoveClock) + ' ' + std::to_string(fullmoveNumber);
+    return fen;
 }
 
 void Board::print() const { // printing the board with current positions
@@ -185,6 +346,12 @@ void Board::update_move(Move m) {
     std::uint64_t maskFrom = 1ULL << m.from;
     std::uint64_t maskTo = 1ULL << m.to;
 
+    // Move counters
+    halfmoveClock = (fpt == PieceType::PAWN || tpt != PieceType::EMPTY) ? 0 : halfmoveClock + 1;
+    if (fc == Color::BLACK) {
+        fullmoveNumber++;
+    }
+
     // Clear en passant target from previous move
     int oldEnPassant = enPassantTarget;
     enPassantTarget = -1;
@@ -279,6 +446,42 @@ void Board::update_move(Move m) {
 
     // Update hash
     hashKey = Zobrist::computeHash(*this);
+    pawnKey = Zobrist::computePawnHash(*this);
+    materialKey = Zobrist::computeMaterialHash(*this);
+    computeEvalTerms();
+}
+
+void Board::computeEvalTerms() {
+    psqMg = 0;
+    psqEg = 0;
+    phase = 0;
+    nonPawnMaterial[WHITE] = 0;
+    nonPawnMaterial[BLACK] = 0;
+    
+    accumulatorIndex = 0;
+    accumulatorOverflow = 0;
+    accumulators[0].computed = false;
+    
+    for (int c = WHITE; c <= BLACK; ++c) {
+        for (int pt = PAWN; pt <= KING; ++pt) {
+            uint64_t pieces = bitboards[c][pt];
+            while (pieces) {
+                updateEvalTerms((Color)c, (PieceType)pt, popLsb(pieces), 1);
+            }
+        }
+    }
+}
+
+void Board::updateEvalTerms(Color color, PieceType piece, int square, int sign) {
+    // psqTable already has black's bonuses negated, the piece values are not
+    Eval::Score bonus = PSQT::psqTable[piece][color][square];
+    int colorSign = (color == WHITE) ? sign : -sign;
+    psqMg += sign * bonus.mg + colorSign * Eval::PIECE_VALUE_MG[piece];
+    psqEg += sign * bonus.eg + colorSign * Eval::PIECE_VALUE_EG[piece];
+    phase += sign * Eval::PIECE_PHASE[piece];
+    if (piece != PAWN) {
+        nonPawnMaterial[color] += sign * Eval::PIECE_VALUE_MG[piece];
+    }
 }
 
 uint64_t Board::computeHash() const {
@@ -322,15 +525,32 @@ BoardState Board::makeMove(const Move& m) {
     state.whiteCanQueenside = whiteCanQueenside;
     state.blackCanKingside = blackCanKingside;
     state.blackCanQueenside = blackCanQueenside;
+    state.halfmoveClock = halfmoveClock;
+    state.pawnKey = pawnKey;
+    state.materialKey = materialKey;
+    state.psqMg = psqMg;
+    state.psqEg = psqEg;
+    state.phase = phase;
+    state.nonPawnMaterial[WHITE] = nonPawnMaterial[WHITE];
+    state.nonPawnMaterial[BLACK] = nonPawnMaterial[BLACK];
     
     // Push current hash to history before making the move
     hashHistory.push_back(hashKey);
     
+    // Pieces added and removed, for the NNUE accumulator update
+    NNUE::DirtyPieces dirty;
+    
     // Get move info
     PieceType fpt = pieceAt(m.from);
     Color fc = colorAt(m.from);
     PieceType finaltype = (m.promotion != PieceType::EMPTY) ? m.promotion : fpt;
     
+    // Move counters
+    halfmoveClock = (fpt == PieceType::PAWN || state.capturedPiece != PieceType::EMPTY) ? 0 : halfmoveClock + 1;
+    if (fc == Color::BLACK) {
+        fullmoveNumber++;
+    }
+    
     std::uint64_t maskFrom = 1ULL << m.from;
     std::uint64_t maskTo = 1ULL << m.to;
     
@@ -352,10 +572,31 @@ BoardState Board::makeMove(const Move& m) {
     
     // XOR out piece from source square
     hashKey ^= Zobrist::pieceKeys[fc][fpt][m.from];
+    if (fpt == PieceType::PAWN) {
+        pawnKey ^= Zobrist::pieceKeys[fc][PAWN][m.from];
+    }
+    updateEvalTerms(fc, fpt, m.from, -1);
+    dirty.add(fc, fpt, m.from, -1);
     
     // Handle captures (XOR out captured piece)
     if (state.capturedPiece != PieceType::EMPTY) {
         hashKey ^= Zobrist::pieceKeys[state.capturedColor][state.capturedPiece][m.to];
+        if (state.capturedPiece == PieceType::PAWN) {
+            pawnKey ^= Zobrist::pieceKeys[state.capturedColor][PAWN][m.to];
+        }
+        // The last piece of the type goes away
+        int count = popcount(bitboards[state.capturedColor][state.capturedPiece]);
+        materialKey ^= Zobrist::pieceKeys[state.capturedColor][state.capturedPiece][count - 1];
+        updateEvalTerms(state.capturedColor, state.capturedPiece, m.to, -1);
+        dirty.add(state.capturedColor, state.capturedPiece, m.to, -1);
+    }
+    
+    // Promotion: one pawn less, one piece of the promoted type more
+    if (m.promotion != PieceType::EMPTY) {
+        int pawnCount = popcount(bitboards[fc][PAWN]);
+        int pieceCount = popcount(bitboards[fc][m.promotion]);
+        materialKey ^= Zobrist::pieceKeys[fc][PAWN][pawnCount - 1];
+        materialKey ^= Zobrist::pieceKeys[fc][m.promotion][pieceCount];
     }
     
     // Handle castling move (king moving 2 squares)
@@ -374,6 +615,10 @@ BoardState Board::makeMove(const Move& m) {
             // XOR out rook from old square, XOR in to new square
             hashKey ^= Zobrist::pieceKeys[fc][ROOK][rookFrom];
             hashKey ^= Zobrist::pieceKeys[fc][ROOK][rookTo];
+            updateEvalTerms(fc, ROOK, rookFrom, -1);
+            updateEvalTerms(fc, ROOK, rookTo, 1);
+            dirty.add(fc, ROOK, rookFrom, -1);
+            dirty.add(fc, ROOK, rookTo, 1);
             
             bitboards[fc][ROOK] &= ~rookMaskFrom;
             bitboards[fc][ROOK] |= rookMaskTo;
@@ -389,6 +634,10 @@ BoardState Board::makeMove(const Move& m) {
             // XOR out rook from old square, XOR in to new square
             hashKey ^= Zobrist::pieceKeys[fc][ROOK][rookFrom];
             hashKey ^= Zobrist::pieceKeys[fc][ROOK][rookTo];
+            updateEvalTerms(fc, ROOK, rookFrom, -1);
+            updateEvalTerms(fc, ROOK, rookTo, 1);
+            dirty.add(fc, ROOK, rookFrom, -1);
+            dirty.add(fc, ROOK, rookTo, 1);
             
             bitboards[fc][ROOK] &= ~rookMaskFrom;
             bitboards[fc][ROOK] |= rookMaskTo;
@@ -403,6 +652,11 @@ BoardState Board::makeMove(const Move& m) {
         // XOR out the captured pawn
         Color enemyColor = (fc == WHITE) ? BLACK : WHITE;
         hashKey ^= Zobrist::pieceKeys[enemyColor][PAWN][capturedPawnSquare];
+        pawnKey ^= Zobrist::pieceKeys[enemyColor][PAWN][capturedPawnSquare];
+        int count = popcount(bitboards[enemyColor][PAWN]);
+        materialKey ^= Zobrist::pieceKeys[enemyColor][PAWN][count - 1];
+        updateEvalTerms(enemyColor, PAWN, capturedPawnSquare, -1);
+        dirty.add(enemyColor, PAWN, capturedPawnSquare, -1);
         
         bitboards[enemyColor][PAWN] &= ~capturedMask;
     }
@@ -423,6 +677,11 @@ BoardState Board::makeMove(const Move& m) {
     // place piece at destination (XOR in the piece)
     bitboards[fc][finaltype] |= maskTo;
     hashKey ^= Zobrist::pieceKeys[fc][finaltype][m.to];
+    if (finaltype == PieceType::PAWN) {
+        pawnKey ^= Zobrist::pieceKeys[fc][PAWN][m.to];
+    }
+    updateEvalTerms(fc, finaltype, m.to, 1);
+    dirty.add(fc, finaltype, m.to, 1);
     
     // Handle promotion (we already XORed out the pawn, now XOR in the promoted piece)
     // (already handled above with finaltype)
@@ -478,6 +737,19 @@ BoardState Board::makeMove(const Move& m) {
     // Update cached bitboards
     updateCachedBitboards();
     
+    // Push the NNUE accumulator of the new position (needs the final bitboards)
+    if (accumulatorIndex + 1 < NNUE::STACK_SIZE) {
+        NNUE::Accumulator& next = accumulators[accumulatorIndex + 1];
+        if (NNUE::isLoaded()) {
+            NNUE::updateAccumulator(accumulators[accumulatorIndex], next, *this, dirty);
+        } else {
+            next.computed = false;
+        }
+        accumulatorIndex++;
+    } else {
+        accumulatorOverflow++;
+    }
+    
     return state;
 }
 
@@ -550,6 +822,22 @@ void Board::unmakeMove(const Move& m, const BoardState& state) {
     whiteCanQueenside = state.whiteCanQueenside;
     blackCanKingside = state.blackCanKingside;
     blackCanQueenside = state.blackCanQueenside;
+    halfmoveClock = state.halfmoveClock;
+    pawnKey = state.pawnKey;
+    materialKey = state.materialKey;
+    psqMg = state.psqMg;
+    psqEg = state.psqEg;
+    phase = state.phase;
+    nonPawnMaterial[WHITE] = state.nonPawnMaterial[WHITE];
+    nonPawnMaterial[BLACK] = state.nonPawnMaterial[BLACK];
+    if (accumulatorOverflow > 0) {
+        accumulatorOverflow--;
+    } else {
+        accumulatorIndex--;
+    }
+    if (fc == Color::BLACK) {
+        fullmoveNumber--;
+    }
     
     // Update cached bitboards
     updateCachedBitboards();
@@ -668,10 +956,24 @@ int Board::popLsb(std::uint64_t &bb) {
 }
 
 void Board::gamestate(const std::vector<std::string> &move_hist) {
-    initStartPosition(); // start from initial position
+    size_t first = 0;
+
+    // Optional FEN header: start from that position instead of replaying the whole game
+    // (a FEN has 7 '/' in its first field, so it can't be mistaken for a move)
+    if (!move_hist.empty()) {
+        const std::string &header = move_hist[0];
+        std::string placement = header.substr(0, header.find(' '));
+        if (std::count(placement.begin(), placement.end(), '/') == 7 && setFromFEN(header)) {
+            first = 1;
+        }
+    }
+    if (first == 0) {
+        initStartPosition(); // start from initial position
+    }
 
     // Apply every move from the history
-    for (const std::string &mv : move_hist) {
+    for (size_t i = first; i < move_hist.size(); i++) {
+        const std::string &mv = move_hist[i];
         if (mv.size() < 4) continue; // Apply every move from history
                                      // skipping invalid lines
         Move m = parseMove(mv);
@@ -885,6 +1187,106 @@ uint64_t Board::getPawnAttacks(uint64_t pawns, Color color) {
     }
 }
 
+uint64_t Board::attackersTo(int square, uint64_t occupied) const {
+    // Pawns attack square from one row behind it (seen from their side)
+    uint64_t whitePawnSquares = 0;
+    uint64_t blackPawnSquares = 0;
+    int col = column(square);
+    int r = row(square);
+    if (r > 0) {
+        if (col > 0) whitePawnSquares |= bit(col - 1, r - 1);
+        if (col < 7) whitePawnSquares |= bit(col + 1, r - 1);
+    }
+    if (r < 7) {
+        if (col > 0) blackPawnSquares |= bit(col - 1, r + 1);
+        if (col < 7) blackPawnSquares |= bit(col + 1, r + 1);
+    }
+
+    uint64_t queens = bitboards[WHITE][QUEEN] | bitboards[BLACK][QUEEN];
+    return (whitePawnSquares & bitboards[WHITE][PAWN])
+         | (blackPawnSquares & bitboards[BLACK][PAWN])
+         | (getKnightAttacks(square) & (bitboards[WHITE][KNIGHT] | bitboards[BLACK][KNIGHT]))
+         | (getKingAttacks(square) & (bitboards[WHITE][KING] | bitboards[BLACK][KING]))
+         | (getRookAttacks(square, occupied) & (bitboards[WHITE][ROOK] | bitboards[BLACK][ROOK] | queens))
+         | (getBishopAttacks(square, occupied) & (bitboards[WHITE][BISHOP] | bitboards[BLACK][BISHOP] | queens));
+}
+
+bool Board::see(const Move& m, int threshold) const {
+    PieceType moved = pieceAt(m.from);
+
+    // Castling and promotions are not scored
+    if (m.promotion != PieceType::EMPTY || (moved == KING && std::abs(m.to - m.from) == 2)) {
+        return threshold <= 0;
+    }
+
+    uint64_t occupied = allPiecesBB ^ (1ULL << m.from) ^ (1ULL << m.to);
+    PieceType captured = pieceAt(m.to);
+    if (moved == PAWN && m.to == enPassantTarget) {
+        captured = PAWN;
+        occupied ^= 1ULL << (m.to + (colorAt(m.from) == WHITE ? -8 : 8));
+    }
+
+    // swap: what we have to gain beyond the threshold, from the side to move next's view
+    int swap = SEE_VALUES[captured] - threshold;
+    if (swap < 0) {
+        return false;  // even a free capture doesn't reach the threshold
+    }
+    swap = SEE_VALUES[moved] - swap;
+    if (swap <= 0) {
+        return true;   // even losing the moved piece keeps us above the threshold
+    }
+
+    uint64_t diagonal = bitboards[WHITE][BISHOP] | bitboards[BLACK][BISHOP]
+                      | bitboards[WHITE][QUEEN] | bitboards[BLACK][QUEEN];
+    uint64_t straight = bitboards[WHITE][ROOK] | bitboards[BLACK][ROOK]
+                      | bitboards[WHITE][QUEEN] | bitboards[BLACK][QUEEN];
+
+    Color stm = colorAt(m.from);
+    uint64_t attackers = attackersTo(m.to, occupied);
+    bool result = true;
+
+    while (true) {
+        stm = (stm == WHITE) ? BLACK : WHITE;
+        attackers &= occupied;
+        uint64_t ours = (stm == WHITE) ? whitePiecesBB : blackPiecesBB;
+        uint64_t stmAttackers = attackers & ours;
+        if (!stmAttackers) {
+            break;
+        }
+        result = !result;
+
+        // Recapture with the least valuable attacker. Removing it can uncover a
+        // slider behind it on the same line (x-ray), which joins the attackers
+        uint64_t bb;
+        if ((bb = stmAttackers & bitboards[stm][PAWN])) {
+            if ((swap = SEE_VALUES[PAWN] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= getBishopAttacks(m.to, occupied) & diagonal;
+        } else if ((bb = stmAttackers & bitboards[stm][KNIGHT])) {
+            if ((swap = SEE_VALUES[KNIGHT] - swap) < result) break;
+            occupied ^= bb & -bb;
+        } else if ((bb = stmAttackers & bitboards[stm][BISHOP])) {
+            if ((swap = SEE_VALUES[BISHOP] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= getBishopAttacks(m.to, occupied) & diagonal;
+        } else if ((bb = stmAttackers & bitboards[stm][ROOK])) {
+            if ((swap = SEE_VALUES[ROOK] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= getRookAttacks(m.to, occupied) & straight;
+        } else if ((bb = stmAttackers & bitboards[stm][QUEEN])) {
+            if ((swap = SEE_VALUES[QUEEN] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= (getBishopAttacks(m.to, occupied) & diagonal)
+                       | (getRookAttacks(m.to, occupied) & straight);
+        } else {
+            // King: it can only recapture if the other side has no attackers left
+            return (attackers & ~ours) ? !result : result;
+        }
+    }
+
+    return result;
+}
+
 // Get all squares attacked by a given color
 uint64_t Board::getAttackedSquares(Color color) const {
     uint64_t attacks = 0;
@@ -1,4 +1,5 @@
 #pragma once
+#include "eval/nnue.h"
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -33,16 +34,28 @@ struct BoardState {
     bool whiteCanQueenside;
     bool blackCanKingside;
     bool blackCanQueenside;
+    int halfmoveClock;
+    uint64_t pawnKey;
+    uint64_t materialKey;
+    int psqMg;
+    int psqEg;
+    int phase;
+    int nonPawnMaterial[2];
 };
 
 class Board {
   public:
     void clear();
     void initStartPosition();
+    // Set up the position from a FEN string, returns false (board cleared) if it can't be parsed
+    // The castling, en passant and move counter fields are optional
+    bool setFromFEN(const std::string &fen);
+    std::string toFEN() const;
     void print() const;
     PieceType pieceAt(int square) const;
     Color colorAt(int square) const;
     void update_move(Move m);
+    // Rebuild the position from a move history, the first line may be a FEN to start from
     void gamestate(const std::vector<std::string> &move_hist);
     
     // make/unmake functions
@@ -128,10 +141,37 @@ class Board {
     bool blackCanQueenside;
     int enPassantTarget; // -1 if none, otherwise square index (0-63)
     Color sideToMove;
+    int halfmoveClock;   // plies since the last capture or pawn move (50-move rule)
+    int fullmoveNumber;  // starts at 1, incremented after each black move
     
     // Zobrist hash key
     uint64_t hashKey;
     
+    // Zobrist key of the pawns only (pawn hash table index)
+    uint64_t pawnKey;
+    
+    // Zobrist key of the piece counts (material hash table index)
+    uint64_t materialKey;
+    
+    // Incremental evaluation terms, updated by makeMove and restored by unmakeMove
+    int psqMg;               // piece values + piece-square bonuses, white's perspective
+    int psqEg;
+    int phase;               // sum of the piece phase weights (not capped, promotions can exceed MAX_PHASE)
+    int nonPawnMaterial[2];  // midgame value of the knights, bishops, rooks and queens of a color
+    
+    // NNUE accumulators, one per makeMove ply: index 0 is the position that was set up,
+    // makeMove computes the next one from the current one and unmakeMove pops it
+    // (mutable: evaluation refreshes an accumulator that isn't computed yet)
+    mutable NNUE::Accumulator accumulators[NNUE::STACK_SIZE];
+    int accumulatorIndex;
+    int accumulatorOverflow;  // makeMove calls past the end of the stack
+    
+    // Recompute the incremental evaluation terms from the bitboards
+    // (the NNUE accumulator is reset and computed on demand)
+    void computeEvalTerms();
+    // Add (sign = 1) or remove (sign = -1) a piece from the incremental evaluation terms
+    void updateEvalTerms(Color color, PieceType piece, int square, int sign);
+    
     // History for repetition detection
     std::vector<uint64_t> hashHistory;
     
@@ -151,6 +191,15 @@ class Board {
     bool isSquareAttackedBy(int square, Color attackerColor) const;
     bool isKingInCheck(Color kingColor) const;
     uint64_t getAttackedSquares(Color color) const;
+    // Pieces of both colors attacking square with the given occupancy
+    uint64_t attackersTo(int square, uint64_t occupied) const;
+
+    // Static exchange evaluation: true if the exchange sequence started by m on its
+    // target square gains at least threshold (both sides always recapture with their
+    // least valuable attacker and may stop when it pays; pins are ignored)
+    // Castling and promotions count as a zero gain
+    static constexpr int SEE_VALUES[7] = { 0, 100, 300, 300, 500, 900, 0 };
+    bool see(const Move& m, int threshold) const;
 
     // Update cached bitboards
     void updateCachedBitboards();
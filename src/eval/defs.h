@@ -26,5 +26,20 @@ constexpr int ROOK_VALUE_EG   = 1380;
 constexpr int QUEEN_VALUE_MG  = 2538;
 constexpr int QUEEN_VALUE_EG  = 2682;
 
+// Piece values indexed by PieceType (EMPTY and KING are worth nothing)
+constexpr int PIECE_VALUE_MG[7] = { 0, PAWN_VALUE_MG, KNIGHT_VALUE_MG, BISHOP_VALUE_MG, ROOK_VALUE_MG, QUEEN_VALUE_MG, 0 };
+constexpr int PIECE_VALUE_EG[7] = { 0, PAWN_VALUE_EG, KNIGHT_VALUE_EG, BISHOP_VALUE_EG, ROOK_VALUE_EG, QUEEN_VALUE_EG, 0 };
+
+// How much each piece type contributes to the game phase
+constexpr int KNIGHT_PHASE = 1;
+constexpr int BISHOP_PHASE = 1;
+constexpr int ROOK_PHASE = 2;
+constexpr int QUEEN_PHASE = 4;
+constexpr int PIECE_PHASE[7] = { 0, 0, KNIGHT_PHASE, BISHOP_PHASE, ROOK_PHASE, QUEEN_PHASE, 0 };
+
+// Maximum phase value (opening position with all pieces, both teams included)
+constexpr int MAX_PHASE = KNIGHT_PHASE * 4 + BISHOP_PHASE * 4 +
+                          ROOK_PHASE * 4 + QUEEN_PHASE * 2;
+
 }
 
@@ -142,10 +142,8 @@ int evaluateKXK(const Board& board, Color strongSide) {
     if (board.sideToMove == weakSide) {
         Board& mutableBoard = const_cast<Board&>(board);
         MoveGenerator gen(mutableBoard, weakSide);
-        Move pseudoLegal[220];
-        size_t pseudoLegalCount = gen.generatePseudoLegalMoves(pseudoLegal);
         Move legalMoves[220];
-        size_t legalCount = gen.filterLegalMoves(pseudoLegal, pseudoLegalCount, legalMoves);
+        size_t legalCount = gen.generateLegalMoves(legalMoves);
         if (legalCount == 0) {
             return VALUE_DRAW;
         }
@@ -216,6 +214,25 @@ int evaluateKNNK(const Board& board, Color strongSide) {
     return VALUE_DRAW;
 }
 
+// KBBK: King + Two Bishops vs King
+// Same colored bishops can't mate, otherwise it is a normal KXK win
+int evaluateKBBK(const Board& board, Color strongSide) {
+    uint64_t bishopBB = board.bitboards[strongSide][BISHOP];
+    bool hasDark = (bishopBB & DarkSquares) != 0;
+    bool hasLight = (bishopBB & ~DarkSquares) != 0;
+    if (!(hasDark && hasLight)) {
+        return VALUE_DRAW;
+    }
+    return evaluateKXK(board, strongSide);
+}
+
+// Insufficient material (KNK, KBK)
+int evaluateDraw(const Board& board, Color strongSide) {
+    (void)board;
+    (void)strongSide;
+    return VALUE_DRAW;
+}
+
 // KRKP: King + Rook vs King + Pawn
 int evaluateKRKP(const Board& board, Color strongSide) {
     Color weakSide = (Color)(1 - strongSide);
@@ -748,22 +765,12 @@ std::optional<EndgameInfo> detectEndgame(const Board& board) {
         return EndgameInfo{BLACK, WHITE, ENDGAME_KBK, true};
     }
     
-    // KBBK with same-colored bishops - DRAW (cannot checkmate)
+    // KBBK - DRAW with same-colored bishops (cannot checkmate), checked by evaluateKBBK
     if (wB == 2 && wN == 0 && wR == 0 && wQ == 0 && wP == 0 && bTotal == 0) {
-        uint64_t bishopBB = board.bitboards[WHITE][BISHOP];
-        bool hasDark = (bishopBB & DarkSquares) != 0;
-        bool hasLight = (bishopBB & ~DarkSquares) != 0;
-        if (!(hasDark && hasLight)) {  // Same color = draw
-            return EndgameInfo{WHITE, BLACK, ENDGAME_KBKB, true};
-        }
+        return EndgameInfo{WHITE, BLACK, ENDGAME_KBBK, true};
     }
     if (bB == 2 && bN == 0 && bR == 0 && bQ == 0 && bP == 0 && wTotal == 0) {
-        uint64_t bishopBB = board.bitboards[BLACK][BISHOP];
-        bool hasDark = (bishopBB & DarkSquares) != 0;
-        bool hasLight = (bishopBB & ~DarkSquares) != 0;
-        if (!(hasDark && hasLight)) {
-            return EndgameInfo{BLACK, WHITE, ENDGAME_KBKB, true};
-        }
+        return EndgameInfo{BLACK, WHITE, ENDGAME_KBBK, true};
     }
     
     // ========================================
@@ -952,74 +959,44 @@ std::optional<EndgameInfo> detectEndgame(const Board& board) {
 // MAIN API FUNCTIONS
 // ============================================================================
 
-int evaluate(const Board& board, const EndgameInfo& info) {
-    int value;
-    
-    switch (info.type) {
-    case ENDGAME_KXK:
-        value = evaluateKXK(board, info.strongSide);
-        break;
-    case ENDGAME_KBNK:
-        value = evaluateKBNK(board, info.strongSide);
-        break;
-    case ENDGAME_KNNK:
-        value = evaluateKNNK(board, info.strongSide);
-        break;
-    case ENDGAME_KRKP:
-        value = evaluateKRKP(board, info.strongSide);
-        break;
-    case ENDGAME_KRKB:
-        value = evaluateKRKB(board, info.strongSide);
-        break;
-    case ENDGAME_KRKN:
-        value = evaluateKRKN(board, info.strongSide);
-        break;
-    case ENDGAME_KQKP:
-        value = evaluateKQKP(board, info.strongSide);
-        break;
-    case ENDGAME_KQKR:
-        value = evaluateKQKR(board, info.strongSide);
-        break;
-    case ENDGAME_KNNKP:
-        value = evaluateKNNKP(board, info.strongSide);
-        break;
+EndgameFunction getEndgameFunction(EndgameType type) {
+    switch (type) {
+    // Evaluation functions
+    case ENDGAME_KXK:    return evaluateKXK;
+    case ENDGAME_KBNK:   return evaluateKBNK;
+    case ENDGAME_KNNK:   return evaluateKNNK;
+    case ENDGAME_KRKP:   return evaluateKRKP;
+    case ENDGAME_KRKB:   return evaluateKRKB;
+    case ENDGAME_KRKN:   return evaluateKRKN;
+    case ENDGAME_KQKP:   return evaluateKQKP;
+    case ENDGAME_KQKR:   return evaluateKQKR;
+    case ENDGAME_KNNKP:  return evaluateKNNKP;
+    case ENDGAME_KBBK:   return evaluateKBBK;
     // Insufficient material - all return draw
     case ENDGAME_KNK:
-    case ENDGAME_KBK:
-    case ENDGAME_KBKB:
-        value = VALUE_DRAW;
-        break;
-    default:
-        value = 0;
-        break;
+    case ENDGAME_KBK:    return evaluateDraw;
+    // Scaling functions
+    case SCALE_KBPsK:    return scaleKBPsK;
+    case SCALE_KQKRPs:   return scaleKQKRPs;
+    case SCALE_KRPKR:    return scaleKRPKR;
+    case SCALE_KRPKB:    return scaleKRPKB;
+    case SCALE_KRPPKRP:  return scaleKRPPKRP;
+    case SCALE_KPsK:     return scaleKPsK;
+    case SCALE_KBPKB:    return scaleKBPKB;
+    case SCALE_KBPPKB:   return scaleKBPPKB;
+    case SCALE_KBPKN:    return scaleKBPKN;
+    default:             return nullptr;
     }
-    
-    return value;
+}
+
+int evaluate(const Board& board, const EndgameInfo& info) {
+    EndgameFunction fn = info.hasEvalFunction ? getEndgameFunction(info.type) : nullptr;
+    return fn ? fn(board, info.strongSide) : 0;
 }
 
 int getScaleFactor(const Board& board, const EndgameInfo& info) {
-    switch (info.type) {
-    case SCALE_KBPsK:
-        return scaleKBPsK(board, info.strongSide);
-    case SCALE_KQKRPs:
-        return scaleKQKRPs(board, info.strongSide);
-    case SCALE_KRPKR:
-        return scaleKRPKR(board, info.strongSide);
-    case SCALE_KRPKB:
-        return scaleKRPKB(board, info.strongSide);
-    case SCALE_KRPPKRP:
-        return scaleKRPPKRP(board, info.strongSide);
-    case SCALE_KPsK:
-        return scaleKPsK(board, info.strongSide);
-    case SCALE_KBPKB:
-        return scaleKBPKB(board, info.strongSide);
-    case SCALE_KBPPKB:
-        return scaleKBPPKB(board, info.strongSide);
-    case SCALE_KBPKN:
-        return scaleKBPKN(board, info.strongSide);
-    default:
-        return SCALE_FACTOR_NONE;
-    }
+    EndgameFunction fn = info.hasEvalFunction ? nullptr : getEndgameFunction(info.type);
+    return fn ? fn(board, info.strongSide) : SCALE_FACTOR_NONE;
 }
 
 } // namespace Endgame
@@ -40,7 +40,7 @@ enum EndgameType {
     // Insufficient material (draws)
     ENDGAME_KNK,     // KN vs K (insufficient material)
     ENDGAME_KBK,     // KB vs K (insufficient material)
-    ENDGAME_KBKB,    // KB vs KB same color (draw)
+    ENDGAME_KBBK,    // KBB vs K (draw when both bishops are on the same color)
     
     // Scaling functions (return scale factor 0-128)
     SCALE_KBPsK,     // KB + pawns vs K
@@ -64,10 +64,17 @@ struct EndgameInfo {
     bool hasEvalFunction;  // true = evaluation function, false = scaling function
 };
 
+// Evaluation and scaling functions share this signature
+using EndgameFunction = int (*)(const Board& board, Color strongSide);
+
 // Main API functions
+// detectEndgame only looks at the piece counts, so its result can be cached
+// per material configuration (Material::Table)
 std::optional<EndgameInfo> detectEndgame(const Board& board);
 int evaluate(const Board& board, const EndgameInfo& info);
 int getScaleFactor(const Board& board, const EndgameInfo& info);
+// Function implementing an endgame type (nullptr for ENDGAME_NONE)
+EndgameFunction getEndgameFunction(EndgameType type);
 
 // Helper functions (used internally)
 int push_to_edge(int sq);
@@ -85,6 +92,8 @@ int evaluateKRKN(const Board& board, Color strongSide);
 int evaluateKQKP(const Board& board, Color strongSide);
 int evaluateKQKR(const Board& board, Color strongSide);
 int evaluateKNNKP(const Board& board, Color strongSide);
+int evaluateKBBK(const Board& board, Color strongSide);
+int evaluateDraw(const Board& board, Color strongSide);
 
 // Scaling functions
 int scaleKBPsK(const Board& board, Color strongSide);
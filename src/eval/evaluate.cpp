@@ -3,19 +3,21 @@
 #include "positional.h"
 #include "psqt.h"
 #include "endgame.h"
+#include "nnue.h"
+#include "../gen.hpp"
+#include "../move.h"
 #include <algorithm>
+#include <cstdlib>
+#include <iostream>
 
 namespace Evaluation {
 
-// constants that determine how much each piece type contributes to the game phase.
-constexpr int KNIGHT_PHASE = 1;
-constexpr int BISHOP_PHASE = 1;
-constexpr int ROOK_PHASE = 2;
-constexpr int QUEEN_PHASE = 4;
-
-// Maximum phase value (opening position with all pieces, both teams included)
-constexpr int MAX_PHASE = KNIGHT_PHASE * 4 + BISHOP_PHASE * 4 +
-                          ROOK_PHASE * 4 + QUEEN_PHASE * 2;
+// Phase weights are shared with the incremental phase counter in Board (defs.h)
+using Eval::KNIGHT_PHASE;
+using Eval::BISHOP_PHASE;
+using Eval::ROOK_PHASE;
+using Eval::QUEEN_PHASE;
+using Eval::MAX_PHASE;
 
 int calculateGamePhase(const Board &board) {
     int phase = 0;
@@ -45,14 +47,14 @@ int interpolate(int mgScore, int egScore, int phase) {
 // BASIC EVALUATION
 // Material + Piece-Square Tables
 int basicEvaluate(const Board &board) {
-    auto [materialMG, materialEG] = Material::evaluateMaterial(board);
-    auto [psqtMG, psqtEG] = PSQT::evaluatePSQT(board);
+    // Piece values and PSQT are kept incrementally by the board, only the imbalance is computed
+    auto [imbalanceMG, imbalanceEG] = Material::evaluateImbalance(board);
 
-    int mgScore = materialMG + psqtMG;
-    int egScore = materialEG + psqtEG;
+    int mgScore = board.psqMg + imbalanceMG;
+    int egScore = board.psqEg + imbalanceEG;
 
-    // Calculate game phase
-    int phase = calculateGamePhase(board);
+    // Game phase, capped in case of promotions
+    int phase = std::min(board.phase, MAX_PHASE);
 
     // Interpolate between midgame and endgame
     int score = interpolate(mgScore, egScore, phase);
@@ -67,15 +69,16 @@ int basicEvaluate(const Board &board) {
 
 // ADVANCED EVALUATION
 // Full positional evaluation
-int advancedEvaluate(const Board &board) {
+int advancedEvaluate(const Board &board, Pawns::Table &pawnTable, Material::Table &materialTable) {
+    // Material, game phase and endgame type only depend on the piece counts
+    const Material::Entry *materialEntry = materialTable.probe(board);
+
     // STEP 1: Check for specialized endgame evaluation
-    auto endgameInfo = Endgame::detectEndgame(board);
-    
-    if (endgameInfo && endgameInfo->hasEvalFunction) {
+    if (materialEntry->evaluationFn) {
         // Use specialized endgame evaluator
-        int value = Endgame::evaluate(board, *endgameInfo);
+        int value = materialEntry->evaluationFn(board, materialEntry->strongSide);
         // Return from side to move perspective
-        if (board.sideToMove == endgameInfo->strongSide) {
+        if (board.sideToMove == materialEntry->strongSide) {
             return value;
         } else {
             return -value;
@@ -83,36 +86,38 @@ int advancedEvaluate(const Board &board) {
     }
     
     // STEP 2: Normal evaluation
-    auto [materialMG, materialEG] = Material::evaluateMaterial(board);
-    auto [psqtMG, psqtEG] = PSQT::evaluatePSQT(board);
-    auto [positionalMG, positionalEG] = Positional::evaluatePositional(board);
+    const Pawns::Entry *pawnEntry = pawnTable.probe(board);
+    int imbalanceMG = materialEntry->mg;
+    int imbalanceEG = materialEntry->eg;
+    auto [positionalMG, positionalEG] = Positional::evaluatePositional(board, *pawnEntry);
 
-    int mgScore = materialMG + psqtMG + positionalMG;
-    int egScore = materialEG + psqtEG + positionalEG;
+    // Piece values + PSQT come from the board's incremental terms
+    int mgScore = board.psqMg + imbalanceMG + positionalMG;
+    int egScore = board.psqEg + imbalanceEG + positionalEG;
 
     // STEP 3: Apply endgame scaling if applicable
     // Scale factors: 0 = draw, 64 = normal, >64 = strong winning chances (boosts score)
     // Stockfish applies scale factor to the endgame score to adjust winning chances
-    if (endgameInfo && !endgameInfo->hasEvalFunction) {
-        int sf = Endgame::getScaleFactor(board, *endgameInfo);
+    if (materialEntry->scalingFn) {
+        int sf = materialEntry->scalingFn(board, materialEntry->strongSide);
         if (sf != Endgame::SCALE_FACTOR_NONE) {
             // Apply scale factor based on which side has the material advantage (strongSide)
             // sf < 64: reduces winning chances (e.g., 0 = draw)
             // sf = 64: normal evaluation
             // sf > 64: boosts winning chances (up to 128 = 2x multiplier)
-            if (endgameInfo->strongSide == WHITE && egScore > 0) {
+            if (materialEntry->strongSide == WHITE && egScore > 0) {
                 egScore = egScore * sf / Endgame::SCALE_FACTOR_NORMAL;
-            } else if (endgameInfo->strongSide == BLACK && egScore < 0) {
+            } else if (materialEntry->strongSide == BLACK && egScore < 0) {
                 egScore = egScore * sf / Endgame::SCALE_FACTOR_NORMAL;
             }
         }
     }
 
     // Adjust the endgame score based on position complexity
-    auto [mgFinal, egFinal] = Positional::applyWinnable(board, mgScore, egScore);
+    auto [mgFinal, egFinal] = Positional::applyWinnable(board, mgScore, egScore, *pawnEntry);
 
-    // calculate game phase
-    int phase = calculateGamePhase(board);
+    // game phase, capped in case of promotions
+    int phase = std::min(board.phase, MAX_PHASE);
 
     // Interpolate between midgame and endgame scores
     int score = interpolate(mgFinal, egFinal, phase);
@@ -127,13 +132,119 @@ int advancedEvaluate(const Board &board) {
     return (board.sideToMove == WHITE) ? score : -score;
 }
 
-// Choose between basic and advanced modes
-int evaluate(const Board &board) {
+// Hash tables for evaluations done outside of a search thread
+static Pawns::Table &localPawnTable() {
+    thread_local Pawns::Table table;
+    return table;
+}
+
+static Material::Table &localMaterialTable() {
+    thread_local Material::Table table;
+    return table;
+}
+
+int advancedEvaluate(const Board &board) {
+    return advancedEvaluate(board, localPawnTable(), localMaterialTable());
+}
+
+// HYBRID: large imbalances are easy for the classical evaluation (and the network
+// is mostly trained on balanced positions), the margin grows as the 50-move counter runs
+static bool useClassical(const Board &board) {
+    return std::abs(board.psqEg) * 16 > HYBRID_THRESHOLD * (16 + board.halfmoveClock);
+}
+
+// Choose between basic, advanced and NNUE modes
+int evaluate(const Board &board, Pawns::Table &pawnTable, Material::Table &materialTable) {
     if constexpr (EVAL_MODE == EvalMode::BASIC) {
         return basicEvaluate(board);
+    } else if constexpr (EVAL_MODE == EvalMode::ADVANCED) {
+        return advancedEvaluate(board, pawnTable, materialTable);
     } else {
-        return advancedEvaluate(board);
+        if (!NNUE::isLoaded() || (EVAL_MODE == EvalMode::HYBRID && useClassical(board))) {
+            return advancedEvaluate(board, pawnTable, materialTable);
+        }
+        return NNUE::evaluate(board);
     }
 }
 
+int evaluate(const Board &board) {
+    return evaluate(board, localPawnTable(), localMaterialTable());
+}
+
+uint64_t evalKey(const Board &board) {
+    // Random constant xored in for classical evaluations of HYBRID
+    constexpr uint64_t CLASSICAL_EVAL_KEY = 0x9E3779B97F4A7C15ULL;
+    if constexpr (EVAL_MODE == EvalMode::HYBRID) {
+        if (NNUE::isLoaded() && useClassical(board)) {
+            return board.hashKey ^ CLASSICAL_EVAL_KEY;
+        }
+    }
+    return board.hashKey;
+}
+
+// DEBUG: INCREMENTAL EVALUATION TERMS
+
+bool verifyEvalTerms(const Board &board) {
+    auto [valuesMG, valuesEG] = Material::evaluatePieceValues(board);
+    auto [psqtMG, psqtEG] = PSQT::evaluatePSQT(board);
+    int phase = calculateGamePhase(board);
+    int npmWhite = Positional::nonPawnMaterial(board, WHITE);
+    int npmBlack = Positional::nonPawnMaterial(board, BLACK);
+
+    bool ok = board.psqMg == valuesMG + psqtMG
+           && board.psqEg == valuesEG + psqtEG
+           && std::min(board.phase, MAX_PHASE) == phase
+           && board.nonPawnMaterial[WHITE] == npmWhite
+           && board.nonPawnMaterial[BLACK] == npmBlack;
+    if (!NNUE::verifyAccumulator(board)) {
+        std::cerr << "ERROR: NNUE accumulator differs from a refresh in " << board.toFEN() << "\n";
+        return false;
+    }
+    if (!Positional::verifyEvalInfo(board, *localPawnTable().probe(board), std::cerr)) {
+        std::cerr << "ERROR: EvalInfo differs from the per-term attack generation in " << board.toFEN() << "\n";
+        return false;
+    }
+    if (!ok) {
+        std::cerr << "ERROR: incremental eval terms differ in " << board.toFEN() << "\n"
+                  << "  psq " << board.psqMg << "/" << board.psqEg << ", expected "
+                  << valuesMG + psqtMG << "/" << valuesEG + psqtEG << "\n"
+                  << "  phase " << board.phase << ", expected " << phase << "\n"
+                  << "  non-pawn material " << board.nonPawnMaterial[WHITE] << "/" << board.nonPawnMaterial[BLACK]
+                  << ", expected " << npmWhite << "/" << npmBlack << "\n";
+    }
+    return ok;
+}
+
+// Checks every node below board, after makeMove and again after unmakeMove
+static bool verifyEvalTermsNode(Board &board, int depth, uint64_t &nodes) {
+    nodes++;
+    if (!verifyEvalTerms(board)) {
+        return false;
+    }
+    if (depth == 0) {
+        return true;
+    }
+
+    MoveGenerator gen(board, board.sideToMove);
+    Move moves[220];
+    size_t count = gen.generateLegalMoves(moves);
+    for (size_t i = 0; i < count; i++) {
+        BoardState state = board.makeMove(moves[i]);
+        bool childOk = verifyEvalTermsNode(board, depth - 1, nodes);
+        board.unmakeMove(moves[i], state);
+        if (!childOk || !verifyEvalTerms(board)) {
+            std::cerr << "  after " << moves[i].toUci() << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool verifyEvalTerms(Board &board, int depth) {
+    uint64_t nodes = 0;
+    bool ok = verifyEvalTermsNode(board, depth, nodes);
+    std::cout << "checked " << nodes << " positions" << std::endl;
+    return ok;
+}
+
 } // namespace Evaluation
@@ -1,23 +1,78 @@
 #pragma once
 #include "../board.h"
+#include "material.h"
+#include "pawns.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
 namespace Evaluation {
 
 // Evaluation mode selection
 enum class EvalMode {
-    BASIC,   // Material + PSQT
-    ADVANCED // Full positional evaluation
+    BASIC,    // Material + PSQT
+    ADVANCED, // Full classical positional evaluation
+    NNUE,     // Neural network (EvalFile), classical while no network is loaded
+    HYBRID    // Neural network, classical for clearly decided positions
 };
 
 // Set this to switch between evaluation modes
-constexpr EvalMode EVAL_MODE = EvalMode::ADVANCED;
+constexpr EvalMode EVAL_MODE = EvalMode::HYBRID;
+
+// HYBRID: positions where |piece values + PSQT| (endgame) exceeds this, scaled up
+// with the 50-move counter, are left to the classical evaluation
+constexpr int HYBRID_THRESHOLD = 550;
 
 // Main evaluation functions
-int evaluate(const Board &board);         // calls basic or advanced
+// The search passes its thread's pawn and material hash tables, the overloads
+// without them use tables private to the calling thread
+int evaluate(const Board &board, Pawns::Table &pawnTable, Material::Table &materialTable); // calls basic, advanced or NNUE
+int evaluate(const Board &board);
 int basicEvaluate(const Board &board);    // Material + PSQT
-int advancedEvaluate(const Board &board); // Full evaluation
+int advancedEvaluate(const Board &board, Pawns::Table &pawnTable, Material::Table &materialTable); // Full evaluation
+int advancedEvaluate(const Board &board);
+
+// Key for cached static evaluations of board (Cache, TT eval field): Board::hashKey, changed
+// when HYBRID leaves a loaded network for the classical evaluation since that choice also
+// depends on the 50-move counter, which the hash key leaves out
+uint64_t evalKey(const Board &board);
 
 // Helper functions
 int calculateGamePhase(const Board &board);
 int interpolate(int mgScore, int egScore, int phase);
+
+// Debug: compare the incremental terms of the board (psqMg / psqEg, phase, nonPawnMaterial
+// and the NNUE accumulator when a network is loaded) and the EvalInfo attack maps with
+// the from-scratch functions, for board itself or every node up to depth plies below it
+bool verifyEvalTerms(const Board &board);
+bool verifyEvalTerms(Board &board, int depth);
+
+// Cache of static evaluations keyed by Board::hashKey, one per search thread
+// Each slot is a single word: the upper 48 key bits and the 16-bit score
+// (side to move's perspective). The lower key bits pick the slot
+class Cache {
+public:
+    static constexpr size_t DEFAULT_ENTRIES = 65536;  // power of 2, 512 KB
+
+    explicit Cache(size_t entries = DEFAULT_ENTRIES) : entries(entries, 0) {}
+
+    bool probe(uint64_t key, int &eval) const {
+        uint64_t e = entries[key & (entries.size() - 1)];
+        if ((e ^ key) & KEY_MASK) {
+            return false;
+        }
+        eval = static_cast<int16_t>(e & ~KEY_MASK);
+        return true;
+    }
+
+    void store(uint64_t key, int eval) {
+        entries[key & (entries.size() - 1)] = (key & KEY_MASK) | static_cast<uint16_t>(eval);
+    }
+
+    void clear() { std::fill(entries.begin(), entries.end(), 0); }
+
+private:
+    static constexpr uint64_t KEY_MASK = ~0xFFFFULL;
+    std::vector<uint64_t> entries;
+};
 } // namespace Evaluation
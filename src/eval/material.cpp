@@ -42,12 +42,7 @@ static constexpr Score QUADRATIC_THEIRS[6][6] = {
 
 // count pieces on a bitboard
 static int countPieces(uint64_t bb) {
-    int count = 0;
-    while (bb) {
-        bb &= bb - 1;
-        count++;
-    }
-    return count;
+    return Board::popcount(bb);
 }
 
 // Calculate material imbalance using Stockfish's formula
@@ -99,8 +94,8 @@ static std::pair<int, int> calculateImbalance(const Board& board, Color us) {
     return {mgBonus / 16, egBonus / 16};
 }
 
-// Function that calculates the material score for the current board position
-std::pair<int, int> evaluateMaterial(const Board& board) {
+// Base piece values, this is what Board::psqMg / psqEg keep incrementally
+std::pair<int, int> evaluatePieceValues(const Board& board) {
     int mgScore = 0;
     int egScore = 0;
     
@@ -142,15 +137,64 @@ std::pair<int, int> evaluateMaterial(const Board& board) {
     egScore -= blackRooks   * ROOK_VALUE_EG;
     egScore -= blackQueens  * QUEEN_VALUE_EG;
     
-    // Calculate material imbalance bonuses
+    return {mgScore, egScore};
+}
+
+// Material imbalance bonuses of both sides
+std::pair<int, int> evaluateImbalance(const Board& board) {
     auto whiteImbalance = calculateImbalance(board, WHITE);
     auto blackImbalance = calculateImbalance(board, BLACK);
     
-    mgScore += whiteImbalance.first - blackImbalance.first;
-    egScore += whiteImbalance.second - blackImbalance.second;
-    
-    return {mgScore, egScore};
+    return {whiteImbalance.first - blackImbalance.first, whiteImbalance.second - blackImbalance.second};
+}
+
+// Function that calculates the material score for the current board position
+std::pair<int, int> evaluateMaterial(const Board& board) {
+    auto [valuesMg, valuesEg] = evaluatePieceValues(board);
+    auto [imbalanceMg, imbalanceEg] = evaluateImbalance(board);
+    return {valuesMg + imbalanceMg, valuesEg + imbalanceEg};
 }
 
+Table::Table(size_t size) : probes(0), hits(0), entries(size) {
+    clear();
 }
 
+void Table::clear() {
+    for (Entry& e : entries) {
+        e = Entry();
+    }
+}
+
+Entry* Table::probe(const Board& board) {
+    uint64_t key = board.materialKey;
+    Entry* e = &entries[key & (entries.size() - 1)];
+
+    probes++;
+    if (e->key == key) {
+        hits++;
+        return e;
+    }
+
+    e->key = key;
+    auto [mg, eg] = evaluateImbalance(board);
+    e->mg = mg;
+    e->eg = eg;
+
+    // Resolve the endgame function once per material configuration
+    e->evaluationFn = nullptr;
+    e->scalingFn = nullptr;
+    e->strongSide = WHITE;
+    if (auto info = Endgame::detectEndgame(board)) {
+        Endgame::EndgameFunction fn = Endgame::getEndgameFunction(info->type);
+        if (info->hasEvalFunction) {
+            e->evaluationFn = fn;
+        } else {
+            e->scalingFn = fn;
+        }
+        e->strongSide = info->strongSide;
+    }
+
+    return e;
+}
+
+}
@@ -1,12 +1,50 @@
 #pragma once
 #include "../board.h"
+#include "endgame.h"
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 namespace Material {
 
 
 // Returns pair of (midgame_score, endgame_score) from white's perspective for material balance
 std::pair<int, int> evaluateMaterial(const Board& board);
+// The two parts of evaluateMaterial: the piece values alone (kept incrementally by the
+// board in psqMg / psqEg) and the imbalance, which is not linear in the piece counts
+std::pair<int, int> evaluatePieceValues(const Board& board);
+std::pair<int, int> evaluateImbalance(const Board& board);
 
-}
+// Cached results for one material configuration (Board::materialKey): the
+// piece counts decide all of them, so the material part of eval is one probe
+struct Entry {
+    uint64_t key;
+    int mg;                                   // evaluateImbalance (the piece values come from the board)
+    int eg;
+    Endgame::EndgameFunction evaluationFn;    // specialized endgame evaluation, nullptr if none
+    Endgame::EndgameFunction scalingFn;       // endgame scale factor, nullptr if none
+    Color strongSide;                         // side the endgame function is called for
+};
+
+// Material hash table, one per search thread (no locking)
+class Table {
+public:
+    static constexpr size_t DEFAULT_ENTRIES = 8192;  // power of 2
+
+    explicit Table(size_t entries = DEFAULT_ENTRIES);
+
+    // Entry for the material of board, computed and stored on a miss
+    Entry* probe(const Board& board);
 
+    void clear();
+
+    // Probe counters, for the hit rate
+    uint64_t probes;
+    uint64_t hits;
+    void resetStats() { probes = hits = 0; }
+
+private:
+    std::vector<Entry> entries;
+};
+
+}
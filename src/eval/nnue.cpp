@@ -0,0 +1,333 @@
+#include "nnue.h"
+#include "../board.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+namespace NNUE {
+
+constexpr char FILE_MAGIC[4] = { 'M', 'C', 'M', 'N' };
+constexpr uint32_t FILE_VERSION = 1;
+
+// Network parameters, see nnue.h for the file layout
+struct Network {
+    alignas(64) int16_t ftBias[L1];
+    alignas(64) int16_t ftWeights[FEATURES * L1];
+    alignas(64) int32_t l1Bias[L2];
+    alignas(64) int8_t l1Weights[L2 * 2 * L1];
+    alignas(64) int32_t l2Bias[L3];
+    alignas(64) int8_t l2Weights[L3 * L2];
+    int32_t outBias;
+    alignas(64) int8_t outWeights[L3];
+};
+
+static std::unique_ptr<Network> network;
+
+// ========================================
+// SIMD kernels (AVX2, SSE4.1 or scalar, picked at compile time)
+// ========================================
+
+// dst = src + sum of the added weight columns - sum of the removed ones
+static void applyColumns(const int16_t* src, int16_t* dst,
+                         const int16_t* const* added, int addCount,
+                         const int16_t* const* removed, int removeCount) {
+#if defined(__AVX2__)
+    for (int i = 0; i < L1; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        for (int a = 0; a < addCount; a++) {
+            v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(added[a] + i)));
+        }
+        for (int r = 0; r < removeCount; r++) {
+            v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(removed[r] + i)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+#elif defined(__SSE4_1__)
+    for (int i = 0; i < L1; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        for (int a = 0; a < addCount; a++) {
+            v = _mm_add_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(added[a] + i)));
+        }
+        for (int r = 0; r < removeCount; r++) {
+            v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(removed[r] + i)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+    }
+#else
+    for (int i = 0; i < L1; i++) {
+        int16_t v = src[i];
+        for (int a = 0; a < addCount; a++) {
+            v += added[a][i];
+        }
+        for (int r = 0; r < removeCount; r++) {
+            v -= removed[r][i];
+        }
+        dst[i] = v;
+    }
+#endif
+}
+
+// Clipped ReLU of the accumulator into uint8 [0, 127], side to move's half first
+static void transform(const Accumulator& acc, Color sideToMove, uint8_t* out) {
+    const int perspectives[2] = { sideToMove, 1 - sideToMove };
+    for (int p = 0; p < 2; p++) {
+        const int16_t* in = acc.values[perspectives[p]];
+        uint8_t* o = out + p * L1;
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256();
+        for (int i = 0; i < L1; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+            // packs works per 128-bit lane, the permute puts the 64-bit blocks back in order
+            __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+            packed = _mm256_permute4x64_epi64(packed, 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + i), packed);
+        }
+#elif defined(__SSE4_1__)
+        const __m128i zero = _mm_setzero_si128();
+        for (int i = 0; i < L1; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+            __m128i packed = _mm_max_epi8(_mm_packs_epi16(a, b), zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o + i), packed);
+        }
+#else
+        for (int i = 0; i < L1; i++) {
+            o[i] = static_cast<uint8_t>(std::clamp<int>(in[i], 0, 127));
+        }
+#endif
+    }
+}
+
+// out[j] = bias[j] + sum over i of in[i] * weights[j * inputs + i], inputs is a multiple of 32
+static void affine(const uint8_t* in, int inputs, const int8_t* weights, const int32_t* bias,
+                   int outputs, int32_t* out) {
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int j = 0; j < outputs; j++) {
+        const int8_t* w = weights + j * inputs;
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < inputs; i += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+            // u8 x i8 pairs summed to i16 (127 * 128 * 2 can't saturate), then to i32
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, y), ones));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        out[j] = bias[j] + _mm_cvtsi128_si32(s);
+    }
+#elif defined(__SSE4_1__)
+    const __m128i ones = _mm_set1_epi16(1);
+    for (int j = 0; j < outputs; j++) {
+        const int8_t* w = weights + j * inputs;
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < inputs; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, y), ones));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        out[j] = bias[j] + _mm_cvtsi128_si32(sum);
+    }
+#else
+    for (int j = 0; j < outputs; j++) {
+        const int8_t* w = weights + j * inputs;
+        int32_t sum = bias[j];
+        for (int i = 0; i < inputs; i++) {
+            sum += in[i] * w[i];
+        }
+        out[j] = sum;
+    }
+#endif
+}
+
+// Hidden layer activation: scale down and clip to [0, 127]
+static void clippedRelu(const int32_t* in, int count, uint8_t* out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = static_cast<uint8_t>(std::clamp(in[i] >> WEIGHT_SCALE_BITS, 0, 127));
+    }
+}
+
+// ========================================
+// Features and accumulators
+// ========================================
+
+// Squares are seen from the perspective's side: black flips the board vertically
+static inline int orient(int perspective, int square) {
+    return perspective == WHITE ? square : square ^ 56;
+}
+
+// HalfKP feature of a (non-king) piece for one perspective
+static inline int featureIndex(int perspective, int kingSq, int color, int piece, int square) {
+    int pieceIndex = (piece - PAWN) * 2 + (color != perspective);
+    return orient(perspective, kingSq) * 640 + pieceIndex * 64 + orient(perspective, square);
+}
+
+static inline int kingSquare(const Board& board, int perspective) {
+    uint64_t king = board.bitboards[perspective][KING];
+    return king ? Board::getLsb(king) : 0;
+}
+
+static void refreshPerspective(Accumulator& acc, const Board& board, int perspective) {
+    int kingSq = kingSquare(board, perspective);
+    const int16_t* added[64];
+    int count = 0;
+    for (int c = WHITE; c <= BLACK; c++) {
+        for (int pt = PAWN; pt <= QUEEN; pt++) {
+            uint64_t pieces = board.bitboards[c][pt];
+            while (pieces) {
+                int sq = Board::popLsb(pieces);
+                added[count++] = network->ftWeights + featureIndex(perspective, kingSq, c, pt, sq) * L1;
+            }
+        }
+    }
+    applyColumns(network->ftBias, acc.values[perspective], added, count, nullptr, 0);
+}
+
+void refreshAccumulator(Accumulator& acc, const Board& board) {
+    refreshPerspective(acc, board, WHITE);
+    refreshPerspective(acc, board, BLACK);
+    acc.computed = true;
+}
+
+void updateAccumulator(const Accumulator& prev, Accumulator& next, const Board& board, const DirtyPieces& dirty) {
+    if (!prev.computed) {
+        refreshAccumulator(next, board);
+        return;
+    }
+
+    for (int perspective = WHITE; perspective <= BLACK; perspective++) {
+        // Our king moved: every feature of this perspective changes
+        bool kingMoved = false;
+        for (int i = 0; i < dirty.count; i++) {
+            kingMoved |= dirty.piece[i] == KING && dirty.color[i] == perspective;
+        }
+        if (kingMoved) {
+            refreshPerspective(next, board, perspective);
+            continue;
+        }
+
+        int kingSq = kingSquare(board, perspective);
+        const int16_t* added[4];
+        const int16_t* removed[4];
+        int addCount = 0;
+        int removeCount = 0;
+        for (int i = 0; i < dirty.count; i++) {
+            if (dirty.piece[i] == KING) {
+                continue;  // HalfKP has no king features
+            }
+            const int16_t* column = network->ftWeights
+                + featureIndex(perspective, kingSq, dirty.color[i], dirty.piece[i], dirty.square[i]) * L1;
+            if (dirty.sign[i] > 0) {
+                added[addCount++] = column;
+            } else {
+                removed[removeCount++] = column;
+            }
+        }
+        applyColumns(prev.values[perspective], next.values[perspective], added, addCount, removed, removeCount);
+    }
+    next.computed = true;
+}
+
+// ========================================
+// Loading and evaluation
+// ========================================
+
+template <typename T>
+static bool readArray(std::istream& in, T* data, size_t count) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(data), sizeof(T) * count));
+}
+
+bool load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    // Header: magic, version and the layer sizes must match this build
+    char magic[4];
+    uint32_t header[5];
+    if (!readArray(in, magic, 4) || !readArray(in, header, 5)
+        || std::memcmp(magic, FILE_MAGIC, 4) != 0 || header[0] != FILE_VERSION
+        || header[1] != FEATURES || header[2] != L1 || header[3] != L2 || header[4] != L3) {
+        return false;
+    }
+
+    // The parameters are stored little-endian, like the hosts we build for
+    auto net = std::make_unique<Network>();
+    bool ok = readArray(in, net->ftBias, L1)
+           && readArray(in, net->ftWeights, static_cast<size_t>(FEATURES) * L1)
+           && readArray(in, net->l1Bias, L2)
+           && readArray(in, net->l1Weights, L2 * 2 * L1)
+           && readArray(in, net->l2Bias, L3)
+           && readArray(in, net->l2Weights, L3 * L2)
+           && readArray(in, &net->outBias, 1)
+           && readArray(in, net->outWeights, L3);
+    // Trailing data means the file is for a different architecture
+    if (!ok || in.peek() != std::ifstream::traits_type::eof()) {
+        return false;
+    }
+
+    network = std::move(net);
+    return true;
+}
+
+bool isLoaded() {
+    return network != nullptr;
+}
+
+int evaluate(const Board& board) {
+    // Positions beyond the accumulator stack have no accumulator of their own
+    Accumulator scratch;
+    const Accumulator* acc = &scratch;
+    if (board.accumulatorOverflow > 0) {
+        refreshAccumulator(scratch, board);
+    } else {
+        Accumulator& current = board.accumulators[board.accumulatorIndex];
+        if (!current.computed) {
+            refreshAccumulator(current, board);
+        }
+        acc = &current;
+    }
+
+    alignas(32) uint8_t input[2 * L1];
+    alignas(32) int32_t hidden1[L2];
+    alignas(32) uint8_t hidden1Out[L2];
+    alignas(32) int32_t hidden2[L3];
+    alignas(32) uint8_t hidden2Out[L3];
+    int32_t output;
+
+    transform(*acc, board.sideToMove, input);
+    affine(input, 2 * L1, network->l1Weights, network->l1Bias, L2, hidden1);
+    clippedRelu(hidden1, L2, hidden1Out);
+    affine(hidden1Out, L2, network->l2Weights, network->l2Bias, L3, hidden2);
+    clippedRelu(hidden2, L3, hidden2Out);
+    affine(hidden2Out, L3, network->outWeights, &network->outBias, 1, &output);
+
+    return output / FV_SCALE;
+}
+
+bool verifyAccumulator(const Board& board) {
+    if (!isLoaded() || board.accumulatorOverflow > 0) {
+        return true;
+    }
+    const Accumulator& current = board.accumulators[board.accumulatorIndex];
+    if (!current.computed) {
+        return true;  // refreshed from scratch when evaluated
+    }
+    Accumulator reference;
+    refreshAccumulator(reference, board);
+    return std::memcmp(current.values, reference.values, sizeof(reference.values)) == 0;
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Efficiently updatable neural network evaluation (NNUE)
+//
+// Architecture: HalfKP (64 king squares x 640 piece-squares) -> 2 x 256 -> 32 -> 32 -> 1
+// The first layer (feature transformer) is kept per position in an Accumulator:
+// makeMove only adds/subtracts the weight columns of the pieces that moved,
+// and a king move refreshes the accumulator of that side from scratch.
+// The accumulators live on a per-ply stack in Board so unmakeMove just pops.
+//
+// Quantization: feature transformer int16, hidden layers int8 weights with int32
+// biases, activations are clipped to [0, 127] and stored as uint8.
+//
+// Network file layout (little-endian):
+//   char[4] "MCMN", uint32 version, uint32 features, uint32 L1, uint32 L2, uint32 L3
+//   int16 ftBias[L1], int16 ftWeights[features][L1]
+//   int32 l1Bias[L2], int8 l1Weights[L2][2 * L1]
+//   int32 l2Bias[L3], int8 l2Weights[L3][L2]
+//   int32 outBias,    int8 outWeights[L3]
+
+class Board;
+
+namespace NNUE {
+
+constexpr int FEATURES = 64 * 640;  // HalfKP: own king square x (10 piece types x 64 squares)
+constexpr int L1 = 256;             // accumulator size per perspective
+constexpr int L2 = 32;
+constexpr int L3 = 32;
+
+constexpr int WEIGHT_SCALE_BITS = 6;  // hidden layer outputs are divided by 64 before clipping
+constexpr int FV_SCALE = 16;          // network output / FV_SCALE = internal eval units
+
+// makeMove plies one Board can keep accumulators for, deeper positions are
+// refreshed from scratch when evaluated (search never goes past MAX_PLY = 64)
+constexpr int STACK_SIZE = 128;
+
+// First layer output of one position, [perspective][neuron]
+struct alignas(32) Accumulator {
+    int16_t values[2][L1];
+    bool computed;  // false: not up to date, refreshed on demand
+};
+
+// Pieces added or removed by one move (at most 4: castling moves king and rook)
+struct DirtyPieces {
+    int count = 0;
+    uint8_t color[4];
+    uint8_t piece[4];
+    uint8_t square[4];
+    int8_t sign[4];  // 1 = added, -1 = removed
+
+    void add(int c, int pt, int sq, int s) {
+        color[count] = c;
+        piece[count] = pt;
+        square[count] = sq;
+        sign[count] = s;
+        count++;
+    }
+};
+
+// Load a network file, returns false (keeping the current network) if it can't be read
+bool load(const std::string& path);
+bool isLoaded();
+
+// Compute acc from the position (both perspectives)
+void refreshAccumulator(Accumulator& acc, const Board& board);
+// Compute next from prev and the pieces the move changed, board is the position after the move
+void updateAccumulator(const Accumulator& prev, Accumulator& next, const Board& board, const DirtyPieces& dirty);
+
+// Network evaluation from the side to move's perspective, needs a loaded network
+int evaluate(const Board& board);
+
+// Debug: true if the current accumulator of board matches a refresh from scratch
+bool verifyAccumulator(const Board& board);
+
+}
@@ -0,0 +1,55 @@
+#include "pawns.h"
+#include "positional.h"
+
+namespace Pawns {
+
+Table::Table(size_t size) : probes(0), hits(0), entries(size) {
+    clear();
+}
+
+void Table::clear() {
+    for (Entry& e : entries) {
+        e = Entry();
+    }
+}
+
+Entry* Table::probe(const Board& board) {
+    uint64_t key = board.pawnKey;
+    Entry* e = &entries[key & (entries.size() - 1)];
+
+    probes++;
+    if (e->key == key) {
+        hits++;
+        return e;
+    }
+
+    e->key = key;
+    auto [mg, eg] = Positional::evaluatePawns(board);
+    e->mg = mg;
+    e->eg = eg;
+
+    for (Color color : {WHITE, BLACK}) {
+        uint64_t pawns = board.bitboards[color][PAWN];
+        e->passedPawns[color] = Positional::getPassedPawns(board, color);
+        e->pawnAttacks[color] = Board::getPawnAttacks(pawns, color);
+
+        uint64_t span = 0;
+        uint64_t pawnsCopy = pawns;
+        while (pawnsCopy) {
+            int sq = Board::popLsb(pawnsCopy);
+            span |= Board::forwardRowsBB(color, sq) & Board::adjacentColumnsBB(Board::column(sq));
+        }
+        e->pawnAttackSpan[color] = span;
+
+        e->semiOpenFiles[color] = 0;
+        for (int column = 0; column < 8; ++column) {
+            if ((pawns & Board::columnBB(column)) == 0) {
+                e->semiOpenFiles[color] |= 1 << column;
+            }
+        }
+    }
+
+    return e;
+}
+
+} // namespace Pawns
@@ -0,0 +1,49 @@
+#pragma once
+#include "../board.h"
+#include <cstdint>
+#include <vector>
+
+namespace Pawns {
+
+// Cached pawn structure of one position, everything in here only depends on the
+// pawns (Board::pawnKey) so it is shared by all positions with the same pawns
+struct Entry {
+    uint64_t key;
+    int mg;                       // Positional::evaluatePawns, white's perspective
+    int eg;
+    uint64_t passedPawns[2];
+    uint64_t pawnAttacks[2];      // squares attacked by the pawns of a color
+    uint64_t pawnAttackSpan[2];   // squares the pawns of a color attack now or after pushing
+    uint8_t semiOpenFiles[2];     // bit f set: the color has no pawn on column f
+
+    bool isSemiOpenFile(Color color, int column) const {
+        return semiOpenFiles[color] & (1 << column);
+    }
+    int passedCount(Color color) const {
+        return Board::popcount(passedPawns[color]);
+    }
+};
+
+// Pawn hash table, one per search thread so it needs no locking
+// Pawn structures repeat a lot inside a search tree, so almost every probe hits
+class Table {
+public:
+    static constexpr size_t DEFAULT_ENTRIES = 16384;  // power of 2
+
+    explicit Table(size_t entries = DEFAULT_ENTRIES);
+
+    // Entry for the pawns of board, computed and stored on a miss
+    Entry* probe(const Board& board);
+
+    void clear();
+
+    // Probe counters, for the hit rate
+    uint64_t probes;
+    uint64_t hits;
+    void resetStats() { probes = hits = 0; }
+
+private:
+    std::vector<Entry> entries;
+};
+
+} // namespace Pawns
@@ -1,6 +1,7 @@
 #include "positional.h"
 #include <algorithm>
 #include <cmath>
+#include <ostream>
 
 namespace Positional {
 
@@ -343,26 +344,69 @@ std::pair<int, int> evaluatePawns(const Board& board) {
 
 
 // ========================================
-// Mobility Evaluation
+// Attack Information
 // ========================================
 
-std::pair<int, int> evaluateMobility(const Board& board) {
-    int mgScore = 0;
-    int egScore = 0;
+void EvalInfo::init(const Board& board, const Pawns::Entry& pawnEntry) {
+    pawns = &pawnEntry;
+    occupied = board.getAllPieces();
+    
+    for (Color color : {WHITE, BLACK}) {
+        uint64_t king = board.bitboards[color][KING];
+        kingZone[color] = king ? getKingZone(Board::getLsb(king), color) : 0;
+    }
     
     for (Color color : {WHITE, BLACK}) {
-        int sign = (color == WHITE) ? 1 : -1;
         Color enemy = (Color)(1 - color);
         
-
-        uint64_t allPieces = board.getAllPieces();
+        attackedBy[color][EMPTY] = 0;
+        attackedBy[color][PAWN] = pawnEntry.pawnAttacks[color];
+        kingAttackersCount[color] = 0;
+        kingAttackersWeight[color] = 0;
+        
+        // Piece attacks (Knights through Kings)
+        for (int pt = KNIGHT; pt <= KING; pt++) {
+            attackedBy[color][pt] = 0;
+            uint64_t pieces = board.bitboards[color][pt];
+            while (pieces) {
+                int sq = Board::popLsb(pieces);
+                uint64_t pieceAttack;
+                
+                if (pt == KNIGHT) pieceAttack = Board::getKnightAttacks(sq);
+                else if (pt == BISHOP) pieceAttack = Board::getBishopAttacks(sq, occupied);
+                else if (pt == ROOK) pieceAttack = Board::getRookAttacks(sq, occupied);
+                else if (pt == QUEEN) pieceAttack = Board::getQueenAttacks(sq, occupied);
+                else pieceAttack = Board::getKingAttacks(sq);
+                
+                pieceAttacks[sq] = pieceAttack;
+                attackedBy[color][pt] |= pieceAttack;
+                
+                // Attackers of the enemy king zone (the king itself doesn't count)
+                if (pt != KING && (pieceAttack & kingZone[enemy])) {
+                    kingAttackersCount[color]++;
+                    kingAttackersWeight[color] += KING_ATTACK_WEIGHTS[pt];
+                }
+            }
+        }
+        
+        // All attacks and double attacks (squares in two or more attackedBy sets)
+        attacks[color] = 0;
+        attacks2[color] = 0;
+        for (int pt = PAWN; pt <= KING; pt++) {
+            attacks2[color] |= attacks[color] & attackedBy[color][pt];
+            attacks[color] |= attackedBy[color][pt];
+        }
+    }
+    
+    for (Color color : {WHITE, BLACK}) {
+        Color enemy = (Color)(1 - color);
         uint64_t ourPawns = board.bitboards[color][PAWN];
         
         uint64_t blockedPawns;
         if (color == WHITE) {
-            blockedPawns = ourPawns & Board::shiftDown(allPieces);
+            blockedPawns = ourPawns & Board::shiftDown(occupied);
         } else {
-            blockedPawns = ourPawns & Board::shiftUp(allPieces);
+            blockedPawns = ourPawns & Board::shiftUp(occupied);
         }
         
         // Low rank pawns: on ranks 2-3 for White, 6-7 for Black
@@ -378,17 +422,34 @@ std::pair<int, int> evaluateMobility(const Board& board) {
         // - our king
         // - our queen  
         // - our developed pawns
-        uint64_t enemyPawnAttacks = Board::getPawnAttacks(board.bitboards[enemy][PAWN], enemy);
-        uint64_t mobilityArea = ~enemyPawnAttacks
-                                & ~board.bitboards[color][KING]
-                                & ~board.bitboards[color][QUEEN]
-                                & ~(ourPawns & ~undevelopedPawns);
+        uint64_t enemyPawnAttacks = pawnEntry.pawnAttacks[enemy];
+        mobilityArea[color] = ~enemyPawnAttacks
+                              & ~board.bitboards[color][KING]
+                              & ~board.bitboards[color][QUEEN]
+                              & ~(ourPawns & ~undevelopedPawns);
+    }
+}
+
+// ========================================
+// Mobility Evaluation
+// ========================================
+
+std::pair<int, int> evaluateMobility(const Board& board, const EvalInfo& ei) {
+    int mgScore = 0;
+    int egScore = 0;
+    
+    for (Color color : {WHITE, BLACK}) {
+        int sign = (color == WHITE) ? 1 : -1;
+        
+        uint64_t allPieces = ei.occupied;
+        uint64_t mobilityArea = ei.mobilityArea[color];
+        uint64_t ourQueens = board.bitboards[color][QUEEN];
         
         // Knights - simple attacks
         uint64_t knights = board.bitboards[color][KNIGHT];
         while (knights) {
             int sq = Board::popLsb(knights);
-            uint64_t attacks = Board::getKnightAttacks(sq);
+            uint64_t attacks = ei.pieceAttacks[sq];
             int mobility = Board::popcount(attacks & mobilityArea);
             mobility = std::min(mobility, 8);
             mgScore += sign * MOBILITY_KNIGHT[mobility].mg;
@@ -400,8 +461,12 @@ std::pair<int, int> evaluateMobility(const Board& board) {
         while (bishops) {
             int sq = Board::popLsb(bishops);
             // See through queens (potential mobility even when blocked)
-            uint64_t bishopOccupancy = allPieces ^ board.bitboards[color][QUEEN];
-            uint64_t attacks = Board::getBishopAttacks(sq, bishopOccupancy);
+            // Without queens that is just the normal attack set
+            uint64_t attacks = ei.pieceAttacks[sq];
+            if (ourQueens) {
+                uint64_t bishopOccupancy = allPieces ^ ourQueens;
+                attacks = Board::getBishopAttacks(sq, bishopOccupancy);
+            }
             int mobility = Board::popcount(attacks & mobilityArea);
             mobility = std::min(mobility, 13);
             mgScore += sign * MOBILITY_BISHOP[mobility].mg;
@@ -414,10 +479,11 @@ std::pair<int, int> evaluateMobility(const Board& board) {
         while (rooksCopy) {
             int sq = Board::popLsb(rooksCopy);
             // See through queens and other rooks (but not the current rook)
-            uint64_t rookOccupancy = allPieces 
-                                    ^ board.bitboards[color][QUEEN]
-                                    ^ (rooks & ~(1ULL << sq));
-            uint64_t attacks = Board::getRookAttacks(sq, rookOccupancy);
+            uint64_t xrayPieces = ourQueens ^ (rooks & ~(1ULL << sq));
+            uint64_t attacks = ei.pieceAttacks[sq];
+            if (xrayPieces) {
+                attacks = Board::getRookAttacks(sq, allPieces ^ xrayPieces);
+            }
             int mobility = Board::popcount(attacks & mobilityArea);
             mobility = std::min(mobility, 14);
             mgScore += sign * MOBILITY_ROOK[mobility].mg;
@@ -428,7 +494,7 @@ std::pair<int, int> evaluateMobility(const Board& board) {
         uint64_t queens = board.bitboards[color][QUEEN];
         while (queens) {
             int sq = Board::popLsb(queens);
-            uint64_t attacks = Board::getQueenAttacks(sq, allPieces);
+            uint64_t attacks = ei.pieceAttacks[sq];
             int mobility = Board::popcount(attacks & mobilityArea);
             mobility = std::min(mobility, 27);
             mgScore += sign * MOBILITY_QUEEN[mobility].mg;
@@ -443,9 +509,10 @@ std::pair<int, int> evaluateMobility(const Board& board) {
 // King Safety Evaluation
 // ========================================
 
-std::pair<int, int> evaluateKingSafety(const Board& board) {
+std::pair<int, int> evaluateKingSafety(const Board& board, const EvalInfo& ei) {
     int mgScore = 0;
     int egScore = 0;
+    const Pawns::Entry& pawnEntry = *ei.pawns;
     
     for (Color color : {WHITE, BLACK}) {
         int sign = (color == WHITE) ? 1 : -1;
@@ -455,61 +522,25 @@ std::pair<int, int> evaluateKingSafety(const Board& board) {
         if (!king) continue;
         
         int kingSq = Board::getLsb(king);
-        uint64_t kingZone = getKingZone(kingSq, color);
+        uint64_t kingZone = ei.kingZone[color];
         
-        uint64_t enemyAttacks = board.getAttackedSquares(enemy);
+        uint64_t enemyAttacks = ei.attacks[enemy];
         uint64_t attackedKingZone = kingZone & enemyAttacks;
         
         int kingDanger = 0;
         
-        int attackerCount = 0;
-        int attackerWeight = 0;
-        
-        uint64_t occupied = board.getAllPieces();
+        // Enemy pieces attacking the king zone
+        int attackerCount = ei.kingAttackersCount[enemy];
+        int attackerWeight = ei.kingAttackersWeight[enemy];
         
-        // Check for potential attacks by enemy pieces
+        uint64_t occupied = ei.occupied;
         uint64_t knights = board.bitboards[enemy][KNIGHT];
-        uint64_t knightsCopy = knights;
-        while (knightsCopy) {
-            int sq = Board::popLsb(knightsCopy);
-            if (Board::getKnightAttacks(sq) & kingZone) {
-                attackerCount++;
-                attackerWeight += KING_ATTACK_WEIGHTS[KNIGHT];
-            }
-        }
-        
         uint64_t bishops = board.bitboards[enemy][BISHOP];
-        uint64_t bishopsCopy = bishops;
-        while (bishopsCopy) {
-            int sq = Board::popLsb(bishopsCopy);
-            if (Board::getBishopAttacks(sq, occupied) & kingZone) {
-                attackerCount++;
-                attackerWeight += KING_ATTACK_WEIGHTS[BISHOP];
-            }
-        }
-        
         uint64_t rooks = board.bitboards[enemy][ROOK];
-        uint64_t rooksCopy = rooks;
-        while (rooksCopy) {
-            int sq = Board::popLsb(rooksCopy);
-            if (Board::getRookAttacks(sq, occupied) & kingZone) {
-                attackerCount++;
-                attackerWeight += KING_ATTACK_WEIGHTS[ROOK];
-            }
-        }
-        
         uint64_t queens = board.bitboards[enemy][QUEEN];
-        uint64_t queensCopy = queens;
-        while (queensCopy) {
-            int sq = Board::popLsb(queensCopy);
-            if (Board::getQueenAttacks(sq, occupied) & kingZone) {
-                attackerCount++;
-                attackerWeight += KING_ATTACK_WEIGHTS[QUEEN];
-            }
-        }
         
         // Safe checks score if enemy can check and checking square is safe
-        uint64_t ourDefense = board.getAttackedSquares(color);
+        uint64_t ourDefense = ei.attacks[color];
         int safeCheckBonus = 0;
         
         //Check safe checks for all pieces types
@@ -542,7 +573,7 @@ std::pair<int, int> evaluateKingSafety(const Board& board) {
         }
         
         //Count enemy attacks on squares directly adjacent to king
-        uint64_t kingAdjacent = Board::getKingAttacks(kingSq);
+        uint64_t kingAdjacent = ei.attackedBy[color][KING];
         int kingAttacksCount = Board::popcount(kingAdjacent & enemyAttacks);
         
         int defensiveBonus = 0;
@@ -553,15 +584,7 @@ std::pair<int, int> evaluateKingSafety(const Board& board) {
         }
         
         // Knight+King defense: our knight and king defending same squares
-        uint64_t ourKnights = board.bitboards[color][KNIGHT];
-        uint64_t ourKnightAttacks = 0;
-        uint64_t ourKnightsCopy = ourKnights;
-        while (ourKnightsCopy) {
-            int sq = Board::popLsb(ourKnightsCopy);
-            ourKnightAttacks |= Board::getKnightAttacks(sq);
-        }
-        uint64_t ourKingAttacks = Board::getKingAttacks(kingSq);
-        if (ourKnightAttacks & ourKingAttacks) {
+        if (ei.attackedBy[color][KNIGHT] & ei.attackedBy[color][KING]) {
             defensiveBonus += 100;
         }
         
@@ -602,7 +625,7 @@ std::pair<int, int> evaluateKingSafety(const Board& board) {
             uint64_t enemyPawns = relevantPawns & board.bitboards[enemy][PAWN];
             
             // Filter our pawns: exclude those attacked by enemy pawns
-            uint64_t enemyPawnAttacks = Board::getPawnAttacks(board.bitboards[enemy][PAWN], enemy);
+            uint64_t enemyPawnAttacks = pawnEntry.pawnAttacks[enemy];
             ourPawns &= ~enemyPawnAttacks;
             
             // Center file
@@ -650,8 +673,8 @@ std::pair<int, int> evaluateKingSafety(const Board& board) {
             }
             
             // King on file penalty
-            bool ourSemiOpen = Board::isOnSemiOpenFile(board, color, kColumn);
-            bool enemySemiOpen = Board::isOnSemiOpenFile(board, enemy, kColumn);
+            bool ourSemiOpen = pawnEntry.isSemiOpenFile(color, kColumn);
+            bool enemySemiOpen = pawnEntry.isSemiOpenFile(enemy, kColumn);
             shelterMg -= KING_ON_FILE[ourSemiOpen][enemySemiOpen].mg;
             shelterEg -= KING_ON_FILE[ourSemiOpen][enemySemiOpen].eg;
             
@@ -668,10 +691,11 @@ std::pair<int, int> evaluateKingSafety(const Board& board) {
 // Piece-Specific Evaluation
 // ========================================
 
-std::pair<int, int> evaluatePieces(const Board& board) {
+std::pair<int, int> evaluatePieces(const Board& board, const EvalInfo& ei) {
     int mgScore = 0;
     int egScore = 0;
-    uint64_t occupied = board.getAllPieces();
+    const Pawns::Entry& pawnEntry = *ei.pawns;
+    uint64_t occupied = ei.occupied;
     
     for (Color color : {WHITE, BLACK}) {
         int sign = (color == WHITE) ? 1 : -1;
@@ -684,11 +708,8 @@ std::pair<int, int> evaluatePieces(const Board& board) {
             int sq = Board::popLsb(rooksCopy);
             int column = Board::column(sq);
             
-            uint64_t ourPawnsOnColumn = board.bitboards[color][PAWN] & Board::columnBB(column);
-            uint64_t enemyPawnsOnColumn = board.bitboards[1 - color][PAWN] & Board::columnBB(column);
-            
-            if (ourPawnsOnColumn == 0) {
-                if (enemyPawnsOnColumn == 0) {
+            if (pawnEntry.isSemiOpenFile(color, column)) {
+                if (pawnEntry.isSemiOpenFile((Color)(1 - color), column)) {
                     // Open file
                     mgScore += sign * ROOK_ON_OPEN_FILE.mg;
                     egScore += sign * ROOK_ON_OPEN_FILE.eg;
@@ -698,8 +719,9 @@ std::pair<int, int> evaluatePieces(const Board& board) {
                     egScore += sign * ROOK_ON_SEMIOPEN_FILE.eg;
                 }
             } else {
-                if (enemyPawnsOnColumn != 0) {
+                if (!pawnEntry.isSemiOpenFile((Color)(1 - color), column)) {
                     // Closed file
+                    uint64_t ourPawnsOnColumn = board.bitboards[color][PAWN] & Board::columnBB(column);
                     uint64_t blockedPawns = ourPawnsOnColumn & Board::shiftDown(occupied);
                     if (color == BLACK) {
                         blockedPawns = ourPawnsOnColumn & Board::shiftUp(occupied);
@@ -721,7 +743,8 @@ std::pair<int, int> evaluatePieces(const Board& board) {
         uint64_t knights = board.bitboards[color][KNIGHT];
         uint64_t knightsCopy = knights;
         uint64_t ourPawns = board.bitboards[color][PAWN];
-        uint64_t enemyPawns = board.bitboards[1 - color][PAWN];
+        // Squares enemy pawns can attack now or after pushing
+        uint64_t enemyAttackSpan = pawnEntry.pawnAttackSpan[1 - color];
         
         // Build outpost rows
         uint64_t outpostRows = (color == WHITE) 
@@ -729,30 +752,22 @@ std::pair<int, int> evaluatePieces(const Board& board) {
             : (Board::rowBB(4) | Board::rowBB(3) | Board::rowBB(2));
         
         // Squares defended by our pawns
-        uint64_t pawnDefended = Board::getPawnAttacks(ourPawns, color);
+        uint64_t pawnDefended = pawnEntry.pawnAttacks[color];
         
         while (knightsCopy) {
             int sq = Board::popLsb(knightsCopy);
             int row = relativeRow(color, sq);
-            int column = Board::column(sq);
             
             // KingProtector: penalty based on distance from our king
             int dist = Board::distance(sq, ourKingSq);
             mgScore -= sign * KING_PROTECTOR_KNIGHT.mg * dist;
             egScore -= sign * KING_PROTECTOR_KNIGHT.eg * dist;
             
-            // Check for outpost
-            if (outpostRows & (1ULL << sq)) {
-                if (pawnDefended & (1ULL << sq)) {
-                    // Check if safe from enemy pawns
-                    uint64_t attackSpan = Board::forwardRowsBB(color, sq) 
-                                        &  Board::adjacentColumnsBB(column);
-                    
-                    if ((enemyPawns & attackSpan) == 0) {
-                        mgScore += sign * KNIGHT_OUTPOST.mg;
-                        egScore += sign * KNIGHT_OUTPOST.eg;
-                    }
-                }
+            // Check for outpost: defended by a pawn and safe from enemy pawns
+            uint64_t sqBB = 1ULL << sq;
+            if ((outpostRows & sqBB) && (pawnDefended & sqBB) && !(enemyAttackSpan & sqBB)) {
+                mgScore += sign * KNIGHT_OUTPOST.mg;
+                egScore += sign * KNIGHT_OUTPOST.eg;
             }
             
             // Knight shielded by friendly pawn
@@ -769,7 +784,6 @@ std::pair<int, int> evaluatePieces(const Board& board) {
         
         while (bishopsCopy) {
             int sq = Board::popLsb(bishopsCopy);
-            int column = Board::column(sq);
             
             // KingProtector: penalty based on distance from our king
             int dist = Board::distance(sq, ourKingSq);
@@ -777,23 +791,16 @@ std::pair<int, int> evaluatePieces(const Board& board) {
             egScore -= sign * KING_PROTECTOR_BISHOP.eg * dist;
             
             // LongDiagonalBishop: bonus if bishop can see at least 2 center squares
-            uint64_t bishopVision = Board::getBishopAttacks(sq, occupied);
+            uint64_t bishopVision = ei.pieceAttacks[sq];
             if (Board::popcount(bishopVision & CENTER_SQUARES) >= 2) {
                 mgScore += sign * LONG_DIAGONAL_BISHOP.mg;
                 egScore += sign * LONG_DIAGONAL_BISHOP.eg;
             }
             
-            if (outpostRows & (1ULL << sq)) {
-                if (pawnDefended & (1ULL << sq)) {
-                    // Check if safe from enemy pawns
-                    uint64_t attackSpan = Board::forwardRowsBB(color, sq) 
-                                        & Board::adjacentColumnsBB(column);
-                    
-                    if ((enemyPawns & attackSpan) == 0) {
-                        mgScore += sign * BISHOP_OUTPOST.mg;
-                        egScore += sign * BISHOP_OUTPOST.eg;
-                    }
-                }
+            uint64_t sqBB = 1ULL << sq;
+            if ((outpostRows & sqBB) && (pawnDefended & sqBB) && !(enemyAttackSpan & sqBB)) {
+                mgScore += sign * BISHOP_OUTPOST.mg;
+                egScore += sign * BISHOP_OUTPOST.eg;
             }
             
             // Bishop shielded by friendly pawn
@@ -813,75 +820,27 @@ std::pair<int, int> evaluatePieces(const Board& board) {
 // Threats Evaluation
 // ========================================
 
-std::pair<int, int> evaluateThreats(const Board& board) {
+std::pair<int, int> evaluateThreats(const Board& board, const EvalInfo& ei) {
     int mgScore = 0;
     int egScore = 0;
+    uint64_t occupied = ei.occupied;
     
     for (Color color : {WHITE, BLACK}) {
         int sign = (color == WHITE) ? 1 : -1;
         Color enemy = (Color)(1 - color);
         
-        uint64_t occupied = board.getAllPieces();
-        
         uint64_t enemyPieces = (enemy == WHITE) ? board.getAllWhitePieces() : board.getAllBlackPieces();
         uint64_t nonPawnEnemies = enemyPieces & ~board.bitboards[enemy][PAWN];
         
-        // Piece attacks tracking
-        uint64_t ourAttackedBy[7] = {0}; // [EMPTY, PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING]
-        uint64_t enemyAttackedBy[7] = {0};
-        uint64_t ourAttacks = 0;
-        uint64_t enemyAttacks = 0;
-        uint64_t ourAttacks2 = 0;
-        uint64_t enemyAttacks2 = 0;
-        
-        ourAttackedBy[PAWN] = Board::getPawnAttacks(board.bitboards[color][PAWN], color);
-        enemyAttackedBy[PAWN] = Board::getPawnAttacks(board.bitboards[enemy][PAWN], enemy);
-        
-        // Calculate our attacks by piece type (Knights through Kings)
-        for (int pt = KNIGHT; pt <= KING; pt++) {
-            uint64_t pieces = board.bitboards[color][pt];
-            while (pieces) {
-                int sq = Board::popLsb(pieces);
-                uint64_t attacks = 0;
-                
-                if (pt == KNIGHT) attacks = Board::getKnightAttacks(sq);
-                else if (pt == BISHOP) attacks = Board::getBishopAttacks(sq, occupied);
-                else if (pt == ROOK) attacks = Board::getRookAttacks(sq, occupied);
-                else if (pt == QUEEN) attacks = Board::getQueenAttacks(sq, occupied);
-                else if (pt == KING) attacks = Board::getKingAttacks(sq);
-                
-                ourAttackedBy[pt] |= attacks;
-            }
-        }
-        
-        // Calculate enemy attacks by piece type (Knights through Kings)
-        for (int pt = KNIGHT; pt <= KING; pt++) {
-            uint64_t pieces = board.bitboards[enemy][pt];
-            while (pieces) {
-                int sq = Board::popLsb(pieces);
-                uint64_t attacks = 0;
-                
-                if (pt == KNIGHT) attacks = Board::getKnightAttacks(sq);
-                else if (pt == BISHOP) attacks = Board::getBishopAttacks(sq, occupied);
-                else if (pt == ROOK) attacks = Board::getRookAttacks(sq, occupied);
-                else if (pt == QUEEN) attacks = Board::getQueenAttacks(sq, occupied);
-                else if (pt == KING) attacks = Board::getKingAttacks(sq);
-                
-                enemyAttackedBy[pt] |= attacks;
-            }
-        }
-        
-        // Compute all attacks and double attacks (attacks on a square by two or more pieces)
-        for (int pt = PAWN; pt <= KING; pt++) {
-            ourAttacks2 |= (ourAttacks & ourAttackedBy[pt]);
-            ourAttacks |= ourAttackedBy[pt];
-            
-            enemyAttacks2 |= (enemyAttacks & enemyAttackedBy[pt]);
-            enemyAttacks |= enemyAttackedBy[pt];
-        }
+        // Attacks by piece type, all attacks and double attacks of both sides
+        const uint64_t* ourAttackedBy = ei.attackedBy[color];
+        const uint64_t* enemyAttackedBy = ei.attackedBy[enemy];
+        uint64_t ourAttacks = ei.attacks[color];
+        uint64_t enemyAttacks = ei.attacks[enemy];
+        uint64_t ourAttacks2 = ei.attacks2[color];
+        uint64_t enemyAttacks2 = ei.attacks2[enemy];
         
         // pawn attacks
-        uint64_t ourPawnAttacks = ourAttackedBy[PAWN];
         uint64_t enemyPawnAttacks = enemyAttackedBy[PAWN];
         
         uint64_t stronglyProtected = enemyPawnAttacks | (enemyAttacks2 & ~ourAttacks2);
@@ -992,7 +951,7 @@ std::pair<int, int> evaluateThreats(const Board& board) {
             uint64_t ourKnights = board.bitboards[color][KNIGHT];
             while (ourKnights) {
                 int sq = Board::popLsb(ourKnights);
-                uint64_t kAttacks = Board::getKnightAttacks(sq);
+                uint64_t kAttacks = ei.pieceAttacks[sq];
                 int knightThreats = Board::popcount(kAttacks & knightAttacksOnQueen & safeMobilityArea);
                 mgScore += sign * knightThreats * (1 + queenImbalance) * KNIGHT_ON_QUEEN.mg;
                 egScore += sign * knightThreats * (1 + queenImbalance) * KNIGHT_ON_QUEEN.eg;
@@ -1005,7 +964,7 @@ std::pair<int, int> evaluateThreats(const Board& board) {
             uint64_t ourBishops = board.bitboards[color][BISHOP];
             while (ourBishops) {
                 int sq = Board::popLsb(ourBishops);
-                uint64_t bAttacks = Board::getBishopAttacks(sq, occupied);
+                uint64_t bAttacks = ei.pieceAttacks[sq];
                 uint64_t sliderThreats = bAttacks & bishopAttacksOnQueen & safeMobilityArea & ourAttacks2;
                 int sliderCount = Board::popcount(sliderThreats);
                 mgScore += sign * sliderCount * (1 + queenImbalance) * SLIDER_ON_QUEEN.mg;
@@ -1015,7 +974,7 @@ std::pair<int, int> evaluateThreats(const Board& board) {
             uint64_t ourRooks = board.bitboards[color][ROOK];
             while (ourRooks) {
                 int sq = Board::popLsb(ourRooks);
-                uint64_t rAttacks = Board::getRookAttacks(sq, occupied);
+                uint64_t rAttacks = ei.pieceAttacks[sq];
                 uint64_t sliderThreats = rAttacks & rookAttacksOnQueen & safeMobilityArea & ourAttacks2;
                 int sliderCount = Board::popcount(sliderThreats);
                 mgScore += sign * sliderCount * (1 + queenImbalance) * SLIDER_ON_QUEEN.mg;
@@ -1031,7 +990,7 @@ std::pair<int, int> evaluateThreats(const Board& board) {
 // Space Evaluation
 // ========================================
 
-std::pair<int, int> evaluateSpace(const Board& board) {
+std::pair<int, int> evaluateSpace(const Board& board, const EvalInfo& ei) {
     int mgScore = 0;
     int egScore = 0;
     
@@ -1056,8 +1015,7 @@ std::pair<int, int> evaluateSpace(const Board& board) {
         Color enemy = (Color)(1 - color);
         
         // Get enemy pawn attacks
-        uint64_t enemyPawns = board.bitboards[enemy][PAWN];
-        uint64_t enemyPawnAttacks = Board::getPawnAttacks(enemyPawns, enemy);
+        uint64_t enemyPawnAttacks = ei.attackedBy[enemy][PAWN];
         
         uint64_t safe = ~enemyPawnAttacks;
         
@@ -1141,9 +1099,8 @@ constexpr int QUEEN_VALUE_MG = 2538;
 constexpr int SCALE_FACTOR_NORMAL = 64;
 
 // Count passed pawns
-int countPassedPawns(const Board& board) {
-    return Board::popcount(getPassedPawns(board, WHITE)) + 
-           Board::popcount(getPassedPawns(board, BLACK));
+int countPassedPawns(const Pawns::Entry& pawnEntry) {
+    return pawnEntry.passedCount(WHITE) + pawnEntry.passedCount(BLACK);
 }
 
 // Calculate non-pawn material for a color
@@ -1194,7 +1151,7 @@ bool pawnsOnSingleFlank(const Board& board) {
 
 
 // Adjusts evaluation based on position complexity and winning chances
-std::pair<int, int> applyWinnable(const Board& board, int mg, int eg) {
+std::pair<int, int> applyWinnable(const Board& board, int mg, int eg, const Pawns::Entry& pawnEntry) {
     // King positions
     uint64_t whiteKing = board.bitboards[WHITE][KING];
     uint64_t blackKing = board.bitboards[BLACK][KING];
@@ -1230,7 +1187,7 @@ std::pair<int, int> applyWinnable(const Board& board, int mg, int eg) {
                     Board::popcount(board.bitboards[BLACK][PAWN]);
     
     // Passed pawns count
-    int passedCount = countPassedPawns(board);
+    int passedCount = countPassedPawns(pawnEntry);
     
     // Check for pure pawn endgame (no non-pawn material)
     bool pureEndgame = (Board::popcount(board.bitboards[WHITE][KNIGHT]) +
@@ -1270,8 +1227,8 @@ std::pair<int, int> applyWinnable(const Board& board, int mg, int eg) {
     Color strongSide = (egAdjusted > 0) ? WHITE : BLACK;
     
     // Calculate non-pawn material for both sides
-    int npm_w = nonPawnMaterial(board, WHITE);
-    int npm_b = nonPawnMaterial(board, BLACK);
+    int npm_w = board.nonPawnMaterial[WHITE];
+    int npm_b = board.nonPawnMaterial[BLACK];
     
     // Initialize scale factor
     int sf = SCALE_FACTOR_NORMAL; // 64
@@ -1281,7 +1238,7 @@ std::pair<int, int> applyWinnable(const Board& board, int mg, int eg) {
         // Pure opposite colored bishop endgame (only bishops and pawns)
         if (npm_w == BISHOP_VALUE_MG && npm_b == BISHOP_VALUE_MG) {
             // Scale based on passed pawns of strong side
-            int strongPassedPawns = Board::popcount(getPassedPawns(board, strongSide));
+            int strongPassedPawns = pawnEntry.passedCount(strongSide);
             sf = 18 + 4 * strongPassedPawns;
         }
         // Mixed material with opposite bishops
@@ -1362,13 +1319,20 @@ std::pair<int, int> applyWinnable(const Board& board, int mg, int eg) {
 // Final Evaluation Function
 // ========================================
 
-std::pair<int, int> evaluatePositional(const Board& board) {
-    auto [pawnMg, pawnEg] = evaluatePawns(board);
-    auto [mobilityMg, mobilityEg] = evaluateMobility(board);
-    auto [kingSafetyMg, kingSafetyEg] = evaluateKingSafety(board);
-    auto [piecesMg, piecesEg] = evaluatePieces(board);
-    auto [threatsMg, threatsEg] = evaluateThreats(board);
-    auto [spaceMg, spaceEg] = evaluateSpace(board);
+std::pair<int, int> evaluatePositional(const Board& board, const Pawns::Entry& pawnEntry) {
+    // Pawn structure score comes from the pawn hash table
+    int pawnMg = pawnEntry.mg;
+    int pawnEg = pawnEntry.eg;
+    
+    // Attack maps shared by all the terms below
+    EvalInfo ei;
+    ei.init(board, pawnEntry);
+    
+    auto [mobilityMg, mobilityEg] = evaluateMobility(board, ei);
+    auto [kingSafetyMg, kingSafetyEg] = evaluateKingSafety(board, ei);
+    auto [piecesMg, piecesEg] = evaluatePieces(board, ei);
+    auto [threatsMg, threatsEg] = evaluateThreats(board, ei);
+    auto [spaceMg, spaceEg] = evaluateSpace(board, ei);
 
     int mgTotal = pawnMg + mobilityMg + kingSafetyMg + piecesMg + threatsMg + spaceMg;
     int egTotal = pawnEg + mobilityEg + kingSafetyEg + piecesEg + threatsEg + spaceEg;
@@ -1376,4 +1340,146 @@ std::pair<int, int> evaluatePositional(const Board& board) {
     return {mgTotal, egTotal};
 }
 
+// ========================================
+// DEBUG: EvalInfo Verification
+// ========================================
+
+// Attacks of the piece on sq, generated from the board like the terms did before EvalInfo
+static uint64_t referencePieceAttacks(int sq, int pt, uint64_t occupied) {
+    if (pt == KNIGHT) return Board::getKnightAttacks(sq);
+    if (pt == BISHOP) return Board::getBishopAttacks(sq, occupied);
+    if (pt == ROOK) return Board::getRookAttacks(sq, occupied);
+    if (pt == QUEEN) return Board::getQueenAttacks(sq, occupied);
+    return Board::getKingAttacks(sq);
+}
+
+// Mobility with the x-ray attack sets always recomputed from the board
+static std::pair<int, int> referenceMobility(const Board& board) {
+    int mgScore = 0;
+    int egScore = 0;
+    uint64_t allPieces = board.getAllPieces();
+    
+    for (Color color : {WHITE, BLACK}) {
+        int sign = (color == WHITE) ? 1 : -1;
+        Color enemy = (Color)(1 - color);
+        uint64_t ourPawns = board.bitboards[color][PAWN];
+        uint64_t ourQueens = board.bitboards[color][QUEEN];
+        uint64_t rooks = board.bitboards[color][ROOK];
+        
+        uint64_t blockedPawns = ourPawns & (color == WHITE ? Board::shiftDown(allPieces) : Board::shiftUp(allPieces));
+        uint64_t lowRanks = (color == WHITE)
+            ? (Board::rowBB(1) | Board::rowBB(2))
+            : (Board::rowBB(6) | Board::rowBB(5));
+        uint64_t undevelopedPawns = blockedPawns | (ourPawns & lowRanks);
+        uint64_t mobilityArea = ~Board::getPawnAttacks(board.bitboards[enemy][PAWN], enemy)
+                                & ~board.bitboards[color][KING]
+                                & ~ourQueens
+                                & ~(ourPawns & ~undevelopedPawns);
+        
+        for (int pt = KNIGHT; pt <= QUEEN; pt++) {
+            uint64_t pieces = board.bitboards[color][pt];
+            while (pieces) {
+                int sq = Board::popLsb(pieces);
+                uint64_t attacks;
+                int maxMobility;
+                const Score* bonus;
+                if (pt == KNIGHT) {
+                    attacks = Board::getKnightAttacks(sq);
+                    maxMobility = 8;
+                    bonus = MOBILITY_KNIGHT;
+                } else if (pt == BISHOP) {
+                    attacks = Board::getBishopAttacks(sq, allPieces ^ ourQueens);
+                    maxMobility = 13;
+                    bonus = MOBILITY_BISHOP;
+                } else if (pt == ROOK) {
+                    attacks = Board::getRookAttacks(sq, allPieces ^ ourQueens ^ (rooks & ~(1ULL << sq)));
+                    maxMobility = 14;
+                    bonus = MOBILITY_ROOK;
+                } else {
+                    attacks = Board::getQueenAttacks(sq, allPieces);
+                    maxMobility = 27;
+                    bonus = MOBILITY_QUEEN;
+                }
+                int mobility = std::min(Board::popcount(attacks & mobilityArea), maxMobility);
+                mgScore += sign * bonus[mobility].mg;
+                egScore += sign * bonus[mobility].eg;
+            }
+        }
+    }
+    
+    return {mgScore, egScore};
+}
+
+bool verifyEvalInfo(const Board& board, const Pawns::Entry& pawnEntry, std::ostream& err) {
+    EvalInfo ei;
+    ei.init(board, pawnEntry);
+    uint64_t occupied = board.getAllPieces();
+    bool ok = true;
+    
+    auto check = [&](bool match, const char* field, Color color, uint64_t got, uint64_t expected) {
+        if (!match && ok) {
+            err << "  EvalInfo " << field << "[" << (color == WHITE ? "white" : "black") << "] "
+                << std::hex << "0x" << got << ", expected 0x" << expected << std::dec << "\n";
+        }
+        ok = ok && match;
+    };
+    
+    for (Color color : {WHITE, BLACK}) {
+        Color enemy = (Color)(1 - color);
+        uint64_t king = board.bitboards[color][KING];
+        uint64_t kingZone = king ? getKingZone(Board::getLsb(king), color) : 0;
+        uint64_t enemyKing = board.bitboards[enemy][KING];
+        uint64_t enemyKingZone = enemyKing ? getKingZone(Board::getLsb(enemyKing), enemy) : 0;
+        
+        uint64_t pawnAttacks = Board::getPawnAttacks(board.bitboards[color][PAWN], color);
+        check(ei.attackedBy[color][PAWN] == pawnAttacks, "attackedBy[PAWN]", color, ei.attackedBy[color][PAWN], pawnAttacks);
+        check(ei.kingZone[color] == kingZone, "kingZone", color, ei.kingZone[color], kingZone);
+        
+        // Per piece attacks and king zone attackers, as the king safety and threat terms generated them
+        uint64_t attackedBy[7] = {0, pawnAttacks, 0, 0, 0, 0, 0};
+        int attackerCount = 0;
+        int attackerWeight = 0;
+        for (int pt = KNIGHT; pt <= KING; pt++) {
+            uint64_t pieces = board.bitboards[color][pt];
+            while (pieces) {
+                int sq = Board::popLsb(pieces);
+                uint64_t attacks = referencePieceAttacks(sq, pt, occupied);
+                check(ei.pieceAttacks[sq] == attacks, "pieceAttacks", color, ei.pieceAttacks[sq], attacks);
+                attackedBy[pt] |= attacks;
+                if (pt != KING && (attacks & enemyKingZone)) {
+                    attackerCount++;
+                    attackerWeight += KING_ATTACK_WEIGHTS[pt];
+                }
+            }
+            check(ei.attackedBy[color][pt] == attackedBy[pt], "attackedBy", color, ei.attackedBy[color][pt], attackedBy[pt]);
+        }
+        check(ei.kingAttackersCount[color] == attackerCount, "kingAttackersCount", color,
+              ei.kingAttackersCount[color], attackerCount);
+        check(ei.kingAttackersWeight[color] == attackerWeight, "kingAttackersWeight", color,
+              ei.kingAttackersWeight[color], attackerWeight);
+        
+        uint64_t attacks = board.getAttackedSquares(color);
+        check(ei.attacks[color] == attacks, "attacks", color, ei.attacks[color], attacks);
+        
+        uint64_t attacks2 = 0;
+        uint64_t seen = 0;
+        for (int pt = PAWN; pt <= KING; pt++) {
+            attacks2 |= seen & attackedBy[pt];
+            seen |= attackedBy[pt];
+        }
+        check(ei.attacks2[color] == attacks2, "attacks2", color, ei.attacks2[color], attacks2);
+    }
+    
+    // The mobility term skips the x-ray lookups when there is nothing to see through
+    auto [mobilityMg, mobilityEg] = evaluateMobility(board, ei);
+    auto [expectedMg, expectedEg] = referenceMobility(board);
+    if (ok && (mobilityMg != expectedMg || mobilityEg != expectedEg)) {
+        err << "  mobility " << mobilityMg << "/" << mobilityEg
+            << ", expected " << expectedMg << "/" << expectedEg << "\n";
+        ok = false;
+    }
+    
+    return ok;
+}
+
 }
\ No newline at end of file
@@ -2,23 +2,49 @@
 #pragma once
 #include "../board.h"
 #include "defs.h"
+#include "pawns.h"
 #include <utility>
 #include <cstdint>
+#include <iosfwd>
 
 namespace Positional {
 
 using Score = Eval::Score;
 
+// Attack information shared by the evaluation terms
+// Filled by init() in a single pass over the pieces, so the attack bitboards of
+// every piece are looked up once per evaluation instead of once per term
+struct EvalInfo {
+    const Pawns::Entry* pawns;   // pawn hash entry of the position
+    uint64_t occupied;
+
+    uint64_t attackedBy[2][7];   // [color][piece type] squares attacked by those pieces
+    uint64_t attacks[2];         // squares attacked by any piece of a color
+    uint64_t attacks2[2];        // squares attacked by at least two of the attackedBy sets
+    uint64_t pieceAttacks[64];   // attacks of the (non-pawn) piece on a square, only set for occupied squares
+
+    uint64_t kingZone[2];        // king + adjacent squares
+    int kingAttackersCount[2];   // pieces of a color attacking the enemy king zone
+    int kingAttackersWeight[2];  // sum of their KING_ATTACK_WEIGHTS
+
+    uint64_t mobilityArea[2];    // squares counted for the mobility of a color
+
+    void init(const Board& board, const Pawns::Entry& pawnEntry);
+};
+
 // Final evaluation function returning (midgame, endgame) scores
-std::pair<int, int> evaluatePositional(const Board& board);
+// pawnEntry is the pawn hash entry of board (Pawns::Table::probe)
+std::pair<int, int> evaluatePositional(const Board& board, const Pawns::Entry& pawnEntry);
 
 // Sub-evaluation functions
+// evaluatePawns computes the pawn structure score from scratch, it is only called
+// on a pawn hash miss
 std::pair<int, int> evaluatePawns(const Board& board);
-std::pair<int, int> evaluateMobility(const Board& board);
-std::pair<int, int> evaluateKingSafety(const Board& board);
-std::pair<int, int> evaluatePieces(const Board& board);
-std::pair<int, int> evaluateThreats(const Board& board);
-std::pair<int, int> evaluateSpace(const Board& board);
+std::pair<int, int> evaluateMobility(const Board& board, const EvalInfo& ei);
+std::pair<int, int> evaluateKingSafety(const Board& board, const EvalInfo& ei);
+std::pair<int, int> evaluatePieces(const Board& board, const EvalInfo& ei);
+std::pair<int, int> evaluateThreats(const Board& board, const EvalInfo& ei);
+std::pair<int, int> evaluateSpace(const Board& board, const EvalInfo& ei);
 
 // Helper functions for attack maps
 uint64_t getKingZone(int kingSq, Color color);
@@ -30,13 +56,17 @@ uint64_t getDoubledPawns(const Board& board, Color color);
 uint64_t getBackwardPawns(const Board& board, Color color);
 
 // Winnable/Complexity adjustment
-std::pair<int, int> applyWinnable(const Board& board, int mg, int eg);
-int countPassedPawns(const Board& board);
+std::pair<int, int> applyWinnable(const Board& board, int mg, int eg, const Pawns::Entry& pawnEntry);
+int countPassedPawns(const Pawns::Entry& pawnEntry);
 
 // Helper functions for scale factor logic
 int nonPawnMaterial(const Board& board, Color color);
 bool hasOppositeBishops(const Board& board);
 bool pawnsOnSingleFlank(const Board& board);
 
+// DEBUG: checks the EvalInfo attack maps and the mobility term against the
+// per-term attack generation they replaced, the first mismatch is written to err
+bool verifyEvalInfo(const Board& board, const Pawns::Entry& pawnEntry, std::ostream& err);
+
 }
 
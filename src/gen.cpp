@@ -1,4 +1,5 @@
 #include "gen.hpp"
+#include <iostream>
 
 // PAWNS ------------------------
 void MoveGenerator::generatePawnMoves(Move moves[220], size_t& moveCount, int from) const {
@@ -176,6 +177,12 @@ void MoveGenerator::generateKingMoves(Move moves[220], size_t& moveCount, int fr
     }
 
     // Castling
+    generateCastling(moves, moveCount, from);
+}
+
+// CASTLING ------------------------
+
+void MoveGenerator::generateCastling(Move moves[220], size_t& moveCount, int from) const {
     std::uint64_t allOccupied = board.getAllPieces();
 
     if (color == Color::WHITE) {
@@ -271,43 +278,477 @@ size_t MoveGenerator::generatePseudoLegalMoves(Move moves[220]) const {
     return moveCount;
 }
 
-size_t MoveGenerator::filterLegalMoves(const Move pseudoLegalMoves[220], size_t pseudoLegalCount, Move legalMoves[220]) {
-    size_t legalCount = 0;
+bool MoveGenerator::isLegalByMakeMove(const Move& move) {
     Color ourColor = color;
     Color opponent = (ourColor == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    PieceType movedPiece = board.pieceAt(move.from);
+    
+    // Handle castling specially - need to check if king passes through check
+    if (movedPiece == PieceType::KING && std::abs(static_cast<int>(move.to) - static_cast<int>(move.from)) == 2) {
+        // King can't castle out of check
+        if (board.isKingInCheck(ourColor)) {
+            return false;
+        }
+        
+        // Check if king passes through attacked square
+        int fromCol = Board::column(move.from);
+        int toCol = Board::column(move.to);
+        int row = Board::row(move.from);
+        int middleCol = (fromCol + toCol) / 2;
+        int middleSq = Board::position(middleCol, row);
+        
+        if (board.isSquareAttackedBy(middleSq, opponent)) {
+            return false;
+        }
+    }
+
+    // Use makeMove/unmakeMove to check legality
+    BoardState state = board.makeMove(move);
+    bool legal = !board.isKingInCheck(ourColor);
+    board.unmakeMove(move, state);
+    return legal;
+}
+
+size_t MoveGenerator::filterLegalMoves(const Move pseudoLegalMoves[220], size_t pseudoLegalCount, Move legalMoves[220]) {
+    size_t legalCount = 0;
 
     for (size_t i = 0; i < pseudoLegalCount; i++) {
-        const Move& move = pseudoLegalMoves[i];
-        PieceType movedPiece = board.pieceAt(move.from);
-        
-        // Handle castling specially - need to check if king passes through check
-        if (movedPiece == PieceType::KING && std::abs(static_cast<int>(move.to) - static_cast<int>(move.from)) == 2) {
-            // King can't castle out of check
-            if (board.isKingInCheck(ourColor)) {
-                continue;
+        if (isLegalByMakeMove(pseudoLegalMoves[i])) {
+            legalMoves[legalCount++] = pseudoLegalMoves[i];
+        }
+    }
+
+    return legalCount;
+}
+
+// LEGAL GENERATION ------------------------
+
+uint64_t MoveGenerator::lineThrough(int a, int b) {
+    uint64_t bbA = 1ULL << a;
+    uint64_t bbB = 1ULL << b;
+    if (Board::getRookAttacks(a, 0) & bbB) {
+        return (Board::getRookAttacks(a, 0) & Board::getRookAttacks(b, 0)) | bbA | bbB;
+    }
+    if (Board::getBishopAttacks(a, 0) & bbB) {
+        return (Board::getBishopAttacks(a, 0) & Board::getBishopAttacks(b, 0)) | bbA | bbB;
+    }
+    return 0;
+}
+
+uint64_t MoveGenerator::between(int a, int b) {
+    uint64_t bbA = 1ULL << a;
+    uint64_t bbB = 1ULL << b;
+    // Rays from both ends, each blocked by the other square, overlap exactly in between
+    if (Board::getRookAttacks(a, 0) & bbB) {
+        return Board::getRookAttacks(a, bbB) & Board::getRookAttacks(b, bbA);
+    }
+    if (Board::getBishopAttacks(a, 0) & bbB) {
+        return Board::getBishopAttacks(a, bbB) & Board::getBishopAttacks(b, bbA);
+    }
+    return 0;
+}
+
+uint64_t MoveGenerator::attackersTo(int square, uint64_t occupied) const {
+    Color them = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+
+    // Enemy pawns attack square from one row behind it (seen from their side)
+    uint64_t pawnSquares = 0;
+    int col = Board::column(square);
+    int pawnRow = Board::row(square) - ((them == Color::WHITE) ? 1 : -1);
+    if (pawnRow >= 0 && pawnRow < 8) {
+        if (col > 0) pawnSquares |= Board::bit(col - 1, pawnRow);
+        if (col < 7) pawnSquares |= Board::bit(col + 1, pawnRow);
+    }
+
+    uint64_t queens = board.bitboards[them][QUEEN];
+    return (pawnSquares & board.bitboards[them][PAWN])
+         | (Board::getKnightAttacks(square) & board.bitboards[them][KNIGHT])
+         | (Board::getKingAttacks(square) & board.bitboards[them][KING])
+         | (Board::getRookAttacks(square, occupied) & (board.bitboards[them][ROOK] | queens))
+         | (Board::getBishopAttacks(square, occupied) & (board.bitboards[them][BISHOP] | queens));
+}
+
+void MoveGenerator::initLegality() {
+    legalityReady = true;
+
+    uint64_t king = board.bitboards[color][KING];
+    if (!king) {
+        // No king (test positions): nothing is pinned or in check
+        kingSquare = -1;
+        checkers = 0;
+        pinned = 0;
+        checkMask = ~0ULL;
+        return;
+    }
+
+    Color them = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    uint64_t occupied = board.getAllPieces();
+    uint64_t ours = (color == Color::WHITE) ? board.getAllWhitePieces() : board.getAllBlackPieces();
+    kingSquare = Board::getLsb(king);
+
+    checkers = attackersTo(kingSquare, occupied);
+
+    // Enemy sliders that would see our king on an empty board, if exactly one of
+    // our pieces stands between them that piece is pinned
+    uint64_t queens = board.bitboards[them][QUEEN];
+    uint64_t snipers = (Board::getRookAttacks(kingSquare, 0) & (board.bitboards[them][ROOK] | queens))
+                     | (Board::getBishopAttacks(kingSquare, 0) & (board.bitboards[them][BISHOP] | queens));
+    pinned = 0;
+    while (snipers) {
+        int sniper = Board::popLsb(snipers);
+        uint64_t blockers = between(kingSquare, sniper) & occupied;
+        if (blockers && !Board::moreThanOne(blockers) && (blockers & ours)) {
+            pinned |= blockers;
+        }
+    }
+
+    // Single check: capture the checker or block the line, double check: king moves only
+    if (!checkers) {
+        checkMask = ~0ULL;
+    } else if (Board::moreThanOne(checkers)) {
+        checkMask = 0;
+    } else {
+        checkMask = checkers | between(kingSquare, Board::getLsb(checkers));
+    }
+}
+
+bool MoveGenerator::isLegal(const Move& move) {
+    if (!legalityReady) {
+        initLegality();
+    }
+    if (kingSquare < 0) {
+        return isLegalByMakeMove(move);
+    }
+
+    uint64_t occupied = board.getAllPieces();
+
+    if (move.from == kingSquare) {
+        // Castling: not out of check, not through or into an attacked square
+        if (std::abs(static_cast<int>(move.to) - static_cast<int>(move.from)) == 2) {
+            int middleSq = (move.from + move.to) / 2;
+            return !checkers && !attackersTo(middleSq, occupied) && !attackersTo(move.to, occupied);
+        }
+        // The king must not step onto an attacked square, including squares on the
+        // line of a checking slider behind the king
+        return !attackersTo(move.to, occupied ^ (1ULL << kingSquare));
+    }
+
+    // En passant removes two pawns from a rank and can uncover a check, it is
+    // rare enough to just play it
+    if (board.pieceAt(move.from) == PAWN && move.to == board.enPassantTarget) {
+        return isLegalByMakeMove(move);
+    }
+
+    // Evasions must capture or block the checker, pinned pieces must stay on the pin line
+    if (!((checkMask >> move.to) & 1)) {
+        return false;
+    }
+    if (((pinned >> move.from) & 1) && !((lineThrough(kingSquare, move.from) >> move.to) & 1)) {
+        return false;
+    }
+    return true;
+}
+
+size_t MoveGenerator::generateLegalMoves(Move moves[220]) {
+    if (!legalityReady) {
+        initLegality();
+    }
+    if (kingSquare < 0) {
+        Move pseudoLegal[220];
+        size_t pseudoLegalCount = generatePseudoLegalMoves(pseudoLegal);
+        return filterLegalMoves(pseudoLegal, pseudoLegalCount, moves);
+    }
+
+    size_t moveCount = 0;
+    uint64_t occupied = board.getAllPieces();
+    uint64_t ours = (color == Color::WHITE) ? board.getAllWhitePieces() : board.getAllBlackPieces();
+
+    // King: the destination must be safe once the king has left its square
+    uint64_t withoutKing = occupied ^ (1ULL << kingSquare);
+    uint64_t kingTargets = Board::getKingAttacks(kingSquare) & ~ours;
+    while (kingTargets) {
+        int to = Board::popLsb(kingTargets);
+        if (!attackersTo(to, withoutKing)) {
+            moves[moveCount++] = Move(kingSquare, to);
+        }
+    }
+
+    // Double check: only the king can move
+    if (Board::moreThanOne(checkers)) {
+        return moveCount;
+    }
+
+    // Castling
+    if (!checkers) {
+        size_t first = moveCount;
+        generateCastling(moves, moveCount, kingSquare);
+        size_t kept = first;
+        for (size_t i = first; i < moveCount; i++) {
+            int middleSq = (moves[i].from + moves[i].to) / 2;
+            if (!attackersTo(middleSq, occupied) && !attackersTo(moves[i].to, occupied)) {
+                moves[kept++] = moves[i];
             }
-            
-            // Check if king passes through attacked square
-            int fromCol = Board::column(move.from);
-            int toCol = Board::column(move.to);
-            int row = Board::row(move.from);
-            int middleCol = (fromCol + toCol) / 2;
-            int middleSq = Board::position(middleCol, row);
-            
-            if (board.isSquareAttackedBy(middleSq, opponent)) {
-                continue;
+        }
+        moveCount = kept;
+    }
+
+    // Pawns: reuse the pseudo-legal generator and keep the moves allowed by the masks
+    uint64_t pawns = board.bitboards[color][PAWN];
+    while (pawns) {
+        int from = Board::popLsb(pawns);
+        uint64_t allowed = checkMask;
+        if ((pinned >> from) & 1) {
+            allowed &= lineThrough(kingSquare, from);
+        }
+
+        size_t first = moveCount;
+        generatePawnMoves(moves, moveCount, from);
+        size_t kept = first;
+        for (size_t i = first; i < moveCount; i++) {
+            bool legal = (moves[i].to == board.enPassantTarget)
+                ? isLegalByMakeMove(moves[i])
+                : ((allowed >> moves[i].to) & 1);
+            if (legal) {
+                moves[kept++] = moves[i];
             }
         }
+        moveCount = kept;
+    }
 
-        // Use makeMove/unmakeMove to check legality
-        BoardState state = board.makeMove(move);
-        bool legal = !board.isKingInCheck(ourColor);
-        board.unmakeMove(move, state);
-        
-        if (legal) {
-            legalMoves[legalCount++] = move;
+    // Knights, bishops, rooks and queens
+    for (int pt = KNIGHT; pt <= QUEEN; ++pt) {
+        uint64_t pieces = board.bitboards[color][pt];
+        while (pieces) {
+            int from = Board::popLsb(pieces);
+            uint64_t attacks = 0;
+            switch (pt) {
+                case KNIGHT: attacks = Board::getKnightAttacks(from); break;
+                case BISHOP: attacks = Board::getBishopAttacks(from, occupied); break;
+                case ROOK:   attacks = Board::getRookAttacks(from, occupied); break;
+                case QUEEN:  attacks = Board::getQueenAttacks(from, occupied); break;
+            }
+            attacks &= ~ours & checkMask;
+            if ((pinned >> from) & 1) {
+                attacks &= lineThrough(kingSquare, from);
+            }
+            while (attacks) {
+                moves[moveCount++] = Move(from, Board::popLsb(attacks));
+            }
         }
     }
 
-    return legalCount;
+    return moveCount;
+}
+
+// Compares both generators at every node below board, counting leaf nodes
+static bool verifyLegalNode(Board& board, int depth, uint64_t& nodes) {
+    MoveGenerator gen(board, board.sideToMove);
+    Move legalMoves[220];
+    size_t legalCount = gen.generateLegalMoves(legalMoves);
+    Move pseudoLegal[220];
+    size_t pseudoLegalCount = gen.generatePseudoLegalMoves(pseudoLegal);
+    Move reference[220];
+    size_t referenceCount = gen.filterLegalMoves(pseudoLegal, pseudoLegalCount, reference);
+
+    auto contains = [](const Move list[220], size_t count, const Move& m) {
+        for (size_t i = 0; i < count; i++) {
+            if (list[i].from == m.from && list[i].to == m.to && list[i].promotion == m.promotion) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    bool ok = (legalCount == referenceCount);
+    for (size_t i = 0; i < referenceCount && ok; i++) {
+        if (!contains(legalMoves, legalCount, reference[i])) {
+            std::cerr << "ERROR: legal generator misses " << reference[i].toUci() << "\n";
+            ok = false;
+        }
+    }
+    // The single move check used by the MovePicker must agree as well
+    for (size_t i = 0; i < pseudoLegalCount && ok; i++) {
+        if (gen.isLegal(pseudoLegal[i]) != contains(reference, referenceCount, pseudoLegal[i])) {
+            std::cerr << "ERROR: isLegal is wrong for " << pseudoLegal[i].toUci() << "\n";
+            ok = false;
+        }
+    }
+    if (!ok) {
+        std::cerr << "  legal generator: " << legalCount << " moves, reference: " << referenceCount
+                  << " moves in " << board.toFEN() << "\n";
+        return false;
+    }
+
+    if (depth <= 1) {
+        nodes += legalCount;
+        return true;
+    }
+    for (size_t i = 0; i < legalCount; i++) {
+        BoardState state = board.makeMove(legalMoves[i]);
+        bool childOk = verifyLegalNode(board, depth - 1, nodes);
+        board.unmakeMove(legalMoves[i], state);
+        if (!childOk) {
+            std::cerr << "  after " << legalMoves[i].toUci() << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MoveGenerator::verifyLegalGeneration(Board& board, int depth) {
+    for (int d = 1; d <= depth; d++) {
+        uint64_t nodes = 0;
+        if (!verifyLegalNode(board, d, nodes)) {
+            return false;
+        }
+        std::cout << "perft " << d << ": " << nodes << std::endl;
+    }
+    return true;
+}
+
+// STAGED GENERATION ------------------------
+
+void MoveGenerator::generatePawnCaptures(Move moves[220], size_t& moveCount) const {
+    int direction = (color == Color::WHITE) ? 1 : -1;
+    int promotionRank = (color == Color::WHITE) ? 7 : 0;
+    std::uint64_t allOccupied = board.getAllPieces();
+    std::uint64_t enemyOccupied = (color == Color::WHITE) ? board.getAllBlackPieces() : board.getAllWhitePieces();
+    std::uint64_t epBit = (board.enPassantTarget != -1) ? (1ULL << board.enPassantTarget) : 0ULL;
+
+    uint64_t pawns = board.bitboards[color][PAWN];
+    while (pawns) {
+        int from = Board::popLsb(pawns);
+        int col = Board::column(from);
+        int forward = from + direction * 8;
+
+        // Diagonal targets, checked against the edge files like generatePawnMoves
+        uint64_t attacks = 0;
+        if (col > 0) attacks |= 1ULL << (forward - 1);
+        if (col < 7) attacks |= 1ULL << (forward + 1);
+
+        // Captures (and capture-promotions)
+        uint64_t captures = attacks & enemyOccupied;
+        while (captures) {
+            int to = Board::popLsb(captures);
+            if (Board::row(to) == promotionRank) {
+                moves[moveCount++] = Move(from, to, PieceType::QUEEN);
+                moves[moveCount++] = Move(from, to, PieceType::ROOK);
+                moves[moveCount++] = Move(from, to, PieceType::BISHOP);
+                moves[moveCount++] = Move(from, to, PieceType::KNIGHT);
+            } else {
+                moves[moveCount++] = Move(from, to);
+            }
+        }
+
+        // En passant
+        if (attacks & epBit) {
+            moves[moveCount++] = Move(from, board.enPassantTarget);
+        }
+
+        // Push promotions
+        if (Board::row(forward) == promotionRank && !((allOccupied >> forward) & 1)) {
+            moves[moveCount++] = Move(from, forward, PieceType::QUEEN);
+            moves[moveCount++] = Move(from, forward, PieceType::ROOK);
+            moves[moveCount++] = Move(from, forward, PieceType::BISHOP);
+            moves[moveCount++] = Move(from, forward, PieceType::KNIGHT);
+        }
+    }
+}
+
+void MoveGenerator::generatePawnQuiets(Move moves[220], size_t& moveCount) const {
+    int direction = (color == Color::WHITE) ? 1 : -1;
+    int startRank = (color == Color::WHITE) ? 1 : 6;
+    int promotionRank = (color == Color::WHITE) ? 7 : 0;
+    std::uint64_t allOccupied = board.getAllPieces();
+
+    uint64_t pawns = board.bitboards[color][PAWN];
+    while (pawns) {
+        int from = Board::popLsb(pawns);
+        int to = from + direction * 8;
+        if (Board::row(to) == promotionRank || ((allOccupied >> to) & 1)) {
+            continue;
+        }
+        moves[moveCount++] = Move(from, to);
+
+        // Double push from the starting rank
+        int to2 = to + direction * 8;
+        if (Board::row(from) == startRank && !((allOccupied >> to2) & 1)) {
+            moves[moveCount++] = Move(from, to2);
+        }
+    }
+}
+
+// Knight, bishop, rook, queen and king moves landing on targets (no castling)
+void MoveGenerator::generatePieceMoves(Move moves[220], size_t& moveCount, uint64_t targets) const {
+    uint64_t occupied = board.getAllPieces();
+
+    for (int pt = KNIGHT; pt <= KING; ++pt) {
+        uint64_t pieces = board.bitboards[color][pt];
+        while (pieces) {
+            int from = Board::popLsb(pieces);
+            uint64_t attacks = 0;
+            switch (pt) {
+                case KNIGHT: attacks = Board::getKnightAttacks(from); break;
+                case BISHOP: attacks = Board::getBishopAttacks(from, occupied); break;
+                case ROOK:   attacks = Board::getRookAttacks(from, occupied); break;
+                case QUEEN:  attacks = Board::getQueenAttacks(from, occupied); break;
+                case KING:   attacks = Board::getKingAttacks(from); break;
+            }
+            attacks &= targets;
+            while (attacks) {
+                moves[moveCount++] = Move(from, Board::popLsb(attacks));
+            }
+        }
+    }
+}
+
+size_t MoveGenerator::generateCaptures(Move moves[220]) const {
+    size_t moveCount = 0;
+    uint64_t enemyOccupied = (color == Color::WHITE) ? board.getAllBlackPieces() : board.getAllWhitePieces();
+
+    generatePawnCaptures(moves, moveCount);
+    generatePieceMoves(moves, moveCount, enemyOccupied);
+    return moveCount;
+}
+
+size_t MoveGenerator::generateQuiets(Move moves[220]) const {
+    size_t moveCount = 0;
+
+    generatePawnQuiets(moves, moveCount);
+    generatePieceMoves(moves, moveCount, ~board.getAllPieces());
+
+    uint64_t king = board.bitboards[color][KING];
+    if (king) {
+        generateCastling(moves, moveCount, Board::getLsb(king));
+    }
+    return moveCount;
+}
+
+bool MoveGenerator::isPseudoLegal(const Move& move) const {
+    if (move.from > 63 || move.to > 63 || move.from == move.to) {
+        return false;
+    }
+    if (!board.isSquareOccupiedByColor(move.from, color)) {
+        return false;
+    }
+
+    // Generate the moves of the piece on the from square and look for the move
+    Move moves[220];
+    size_t moveCount = 0;
+    switch (board.pieceAt(move.from)) {
+        case PAWN:   generatePawnMoves(moves, moveCount, move.from); break;
+        case KNIGHT: generateKnightMoves(moves, moveCount, move.from); break;
+        case BISHOP: generateBishopMoves(moves, moveCount, move.from); break;
+        case ROOK:   generateRookMoves(moves, moveCount, move.from); break;
+        case QUEEN:  generateQueenMoves(moves, moveCount, move.from); break;
+        case KING:   generateKingMoves(moves, moveCount, move.from); break;
+        default: return false;
+    }
+
+    for (size_t i = 0; i < moveCount; i++) {
+        if (moves[i].to == move.to && moves[i].promotion == move.promotion) {
+            return true;
+        }
+    }
+    return false;
 }
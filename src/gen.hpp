@@ -9,7 +9,30 @@ public:
     
     // Main move generation functions
     size_t generatePseudoLegalMoves(Move moves[220]) const;
+    // Fully legal generation: checkers, pinned pieces and the check evasion mask
+    // are computed once per position, so no move has to be played to test it
+    size_t generateLegalMoves(Move moves[220]);
+    // Reference legality filter, plays every move with makeMove/unmakeMove
     size_t filterLegalMoves(const Move pseudoLegalMoves[220], size_t pseudoLegalCount, Move legalMoves[220]);
+
+    // Walks the game tree to depth and compares generateLegalMoves with
+    // generatePseudoLegalMoves + filterLegalMoves at every node
+    // Returns true if both generators agree everywhere (perft counts are printed)
+    static bool verifyLegalGeneration(Board& board, int depth);
+
+    // Staged generation (used by the MovePicker), together they give the same
+    // set as generatePseudoLegalMoves
+    // Captures, en passant and all promotions
+    size_t generateCaptures(Move moves[220]) const;
+    // Everything else: quiet pawn pushes, quiet piece moves and castling
+    size_t generateQuiets(Move moves[220]) const;
+
+    // Checks for a single move
+    // isPseudoLegal: the move could have been generated in this position (used to
+    // validate TT and killer moves), isLegal: a pseudo-legal move doesn't leave our king
+    // in check (uses the same pin/check masks as generateLegalMoves)
+    bool isPseudoLegal(const Move& move) const;
+    bool isLegal(const Move& move);
     
     // Individual piece move generators
     // moves array and moveCount are passed by reference to be modified
@@ -21,6 +44,28 @@ public:
     void generateKingMoves  (Move moves[220], size_t& moveCount, int from) const;
 
 private:
+    // Helpers for the staged generation
+    void generatePawnCaptures(Move moves[220], size_t& moveCount) const;
+    void generatePawnQuiets(Move moves[220], size_t& moveCount) const;
+    void generatePieceMoves(Move moves[220], size_t& moveCount, uint64_t targets) const;
+    void generateCastling(Move moves[220], size_t& moveCount, int from) const;
+
+    // Legality info, computed on first use
+    void initLegality();
+    // Enemy pieces attacking square with the given occupancy
+    uint64_t attackersTo(int square, uint64_t occupied) const;
+    // Full rank, file or diagonal through two aligned squares (0 if not aligned)
+    static uint64_t lineThrough(int a, int b);
+    // Squares strictly between two aligned squares (0 if not aligned)
+    static uint64_t between(int a, int b);
+    bool isLegalByMakeMove(const Move& move);
+
     Board& board;
     Color color;
+
+    bool legalityReady = false;
+    int kingSquare = -1;
+    uint64_t checkers = 0;    // enemy pieces giving check
+    uint64_t pinned = 0;      // our pieces pinned to our king
+    uint64_t checkMask = 0;   // squares a non-king move must land on (everything when not in check)
 };
@@ -59,11 +59,9 @@ int main(int argc, char *argv[]) {
     // Initialize magic bitboards
     Magic::init();
     
-    // Initialize transposition table (already initialized globally, but clear it)
-    TT::tt.clear();
-
     std::string inputfile;
     std::string outputfile;
+    std::string ttfile;
 
     for (int i = 1; i < argc; i++) {
         if (std::string(argv[i]) == "-H") {
@@ -72,6 +70,18 @@ int main(int argc, char *argv[]) {
         if (std::string(argv[i]) == "-m") {
             outputfile = argv[i + 1];
         }
+        if (std::string(argv[i]) == "-T") {
+            ttfile = argv[i + 1];
+        }
+    }
+
+    // Allocate transposition table
+    // With -T <file> it is memory-mapped, so the next move of the game reuses this search
+    if (ttfile.empty() || !TT::tt.mapFile(ttfile, TT::DEFAULT_SIZE_MB)) {
+        if (!ttfile.empty()) {
+            std::cerr << "Could not map TT file " << ttfile << ", using an in-memory table\n";
+        }
+        TT::tt.resize(TT::DEFAULT_SIZE_MB);
     }
 
     if (inputfile.empty()) {
@@ -86,6 +96,7 @@ int main(int argc, char *argv[]) {
     Board board;
     board.gamestate(move_hist);
     board.print();
+    std::cout << "FEN: " << board.toFEN() << "\n";
 
     // printing evaluation of position
     std::cout << "Evaluation = " << Evaluation::evaluate(board) << "\n";
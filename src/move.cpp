@@ -10,6 +10,18 @@ std::string Move::toString() const {
     return result;
 }
 
+std::string Move::toUci() const {
+    std::string result = toString();
+    switch (promotion) {
+        case PieceType::QUEEN:  result += 'q'; break;
+        case PieceType::ROOK:   result += 'r'; break;
+        case PieceType::BISHOP: result += 'b'; break;
+        case PieceType::KNIGHT: result += 'n'; break;
+        default: break;
+    }
+    return result;
+}
+
 Move parseMove(const std::string &s) {
     int startcol = s[0] - 'a';
     int startrow = s[1] - '1';
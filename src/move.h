@@ -15,6 +15,8 @@ struct Move {
         : from(f), to(t), promotion(p), score(0) {}
 
     std::string toString() const;
+    // UCI notation, including the promotion piece (e.g. "e7e8q")
+    std::string toUci() const;
     
     // Check if this is a null move
     bool isNull() const {
@@ -28,6 +30,16 @@ struct Move {
         m.to = 65;
         return m;
     }
+    
+    // Compact 16-bit encoding (from: 6 bits, to: 6 bits, promotion: 3 bits)
+    // used to pack moves into transposition table entries
+    uint16_t encode() const {
+        return static_cast<uint16_t>(from | (to << 6) | (promotion << 12));
+    }
+    
+    static Move decode(uint16_t data) {
+        return Move(data & 0x3F, (data >> 6) & 0x3F, static_cast<PieceType>((data >> 12) & 0x7));
+    }
 };
 
 Move parseMove(const std::string &s);
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "movepick.h"
+#include <utility>
+
+// Ordering scores (same priorities as the old scoreMove)
+constexpr int CAPTURE_SCORE = 1000000;
+constexpr int PROMOTION_SCORE = 900000;
+
+MovePicker::MovePicker(Board& b, const Move& tt, const Search::KillerMoves& killers, const int (&hist)[64][64])
+    : board(b), gen(b, b.sideToMove), ttMove(tt), history(hist), killerIndex(0),
+      cur(0), end(0), badCaptures(0), badIndex(0) {
+    killerMoves[0] = killers.moves[0];
+    killerMoves[1] = killers.moves[1];
+
+    // Skip the TT stage if there is no usable TT move
+    bool validTT = (ttMove.from != 0 || ttMove.to != 0) && gen.isPseudoLegal(ttMove);
+    stage = validTT ? TT_MOVE : GEN_CAPTURES;
+    if (!validTT) {
+        ttMove = Move();
+    }
+}
+
+MovePicker::MovePicker(Board& b)
+    : board(b), gen(b, b.sideToMove), ttMove(), history(nullptr), stage(QS_GEN_CAPTURES),
+      killerIndex(0), cur(0), end(0), badCaptures(0), badIndex(0) {}
+
+void MovePicker::scoreCaptures(Move* begin, Move* last) {
+    for (Move* m = begin; m != last; ++m) {
+        PieceType victim = board.pieceAt(m->to);
+        PieceType attacker = board.pieceAt(m->from);
+        if (victim == PieceType::EMPTY && attacker == PAWN && m->to == board.enPassantTarget) {
+            victim = PAWN;  // en passant
+        }
+
+        if (victim != PieceType::EMPTY) {
+            // MVV-LVA
+            m->score = CAPTURE_SCORE + 10 * Search::pieceValues[victim] - Search::pieceValues[attacker];
+        } else {
+            m->score = PROMOTION_SCORE + Search::pieceValues[m->promotion];
+        }
+    }
+}
+
+void MovePicker::scoreQuiets(Move* begin, Move* last) {
+    for (Move* m = begin; m != last; ++m) {
+        m->score = history[m->from][m->to];
+    }
+}
+
+Move& MovePicker::pickBest() {
+    size_t best = cur;
+    for (size_t i = cur + 1; i < end; i++) {
+        if (moves[i].score > moves[best].score) {
+            best = i;
+        }
+    }
+    std::swap(moves[cur], moves[best]);
+    return moves[cur++];
+}
+
+bool MovePicker::isBadCapture(const Move& move) const {
+    // Loses material once the exchange on the target square is played out
+    return !board.see(move, 0);
+}
+
+bool MovePicker::isSpecialMove(const Move& move) const {
+    return Search::KillerMoves::sameMove(move, ttMove)
+        || Search::KillerMoves::sameMove(move, killerMoves[0])
+        || Search::KillerMoves::sameMove(move, killerMoves[1]);
+}
+
+bool MovePicker::nextMove(Move& move) {
+    while (true) {
+        switch (stage) {
+        case TT_MOVE:
+            stage = GEN_CAPTURES;
+            if (gen.isLegal(ttMove)) {
+                move = ttMove;
+                return true;
+            }
+            break;
+
+        case GEN_CAPTURES:
+            cur = 0;
+            end = gen.generateCaptures(moves);
+            scoreCaptures(moves, moves + end);
+            stage = GOOD_CAPTURES;
+            break;
+
+        case GOOD_CAPTURES:
+            while (cur < end) {
+                Move& m = pickBest();
+                if (Search::KillerMoves::sameMove(m, ttMove)) {
+                    continue;
+                }
+                // Losing captures are moved to the front of the array and tried last
+                if (isBadCapture(m)) {
+                    moves[badCaptures++] = m;
+                    continue;
+                }
+                if (gen.isLegal(m)) {
+                    move = m;
+                    return true;
+                }
+            }
+            stage = KILLERS;
+            break;
+
+        case KILLERS:
+            while (killerIndex < 2) {
+                const Move& killer = killerMoves[killerIndex++];
+                // Killers must be quiet moves that are playable here
+                if ((killer.from == 0 && killer.to == 0)
+                    || Search::KillerMoves::sameMove(killer, ttMove)
+                    || (killerIndex == 2 && Search::KillerMoves::sameMove(killer, killerMoves[0]))
+                    || killer.promotion != PieceType::EMPTY
+                    || !board.isSquareEmpty(killer.to)
+                    || !gen.isPseudoLegal(killer)) {
+                    continue;
+                }
+                // en passant lands on an empty square, it is generated as a capture
+                if (board.pieceAt(killer.from) == PAWN && killer.to == board.enPassantTarget) {
+                    continue;
+                }
+                if (gen.isLegal(killer)) {
+                    move = killer;
+                    return true;
+                }
+            }
+            stage = GEN_QUIETS;
+            break;
+
+        case GEN_QUIETS:
+            // Quiets go after the bad captures in the array
+            cur = badCaptures;
+            end = badCaptures + gen.generateQuiets(moves + badCaptures);
+            scoreQuiets(moves + cur, moves + end);
+            stage = QUIETS;
+            break;
+
+        case QUIETS:
+            while (cur < end) {
+                Move& m = pickBest();
+                if (isSpecialMove(m)) {
+                    continue;
+                }
+                if (gen.isLegal(m)) {
+                    move = m;
+                    return true;
+                }
+            }
+            stage = BAD_CAPTURES;
+            break;
+
+        case BAD_CAPTURES:
+            // Already in MVV-LVA order
+            while (badIndex < badCaptures) {
+                const Move& m = moves[badIndex++];
+                if (gen.isLegal(m)) {
+                    move = m;
+                    return true;
+                }
+            }
+            stage = DONE;
+            break;
+
+        case QS_GEN_CAPTURES:
+            cur = 0;
+            end = gen.generateCaptures(moves);
+            scoreCaptures(moves, moves + end);
+            stage = QS_CAPTURES;
+            break;
+
+        case QS_CAPTURES:
+            while (cur < end) {
+                Move& m = pickBest();
+                if (gen.isLegal(m)) {
+                    move = m;
+                    return true;
+                }
+            }
+            stage = DONE;
+            break;
+
+        case DONE:
+            return false;
+        }
+    }
+}
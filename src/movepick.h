@@ -0,0 +1,62 @@
+#pragma once
+#include "board.h"
+#include "gen.hpp"
+#include "move.h"
+#include "search.h"
+
+// Staged move picker
+// Instead of generating, legality-checking and sorting every move up front, moves
+// are produced one stage at a time and each stage is only generated when the
+// previous one is exhausted. Inside a stage the best remaining move is picked with
+// a partial selection sort, and legality is only checked for moves we actually return.
+// At cut nodes that fail high on the TT move or the first capture, the quiet moves
+// are never generated at all.
+class MovePicker {
+public:
+    // Main search: TT move, good captures, killers, quiets by history, bad captures
+    MovePicker(Board& b, const Move& ttMove, const Search::KillerMoves& killers, const int (&history)[64][64]);
+    // Quiescence search: captures and promotions only
+    explicit MovePicker(Board& b);
+
+    // Writes the next legal move to move, returns false when there are no moves left
+    bool nextMove(Move& move);
+
+private:
+    enum Stage {
+        TT_MOVE,
+        GEN_CAPTURES,
+        GOOD_CAPTURES,
+        KILLERS,
+        GEN_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        // Quiescence stages
+        QS_GEN_CAPTURES,
+        QS_CAPTURES,
+        DONE
+    };
+
+    // Score every move in [begin, end) for ordering
+    void scoreCaptures(Move* begin, Move* end);
+    void scoreQuiets(Move* begin, Move* end);
+    // Partial selection sort: move the best remaining move to cur and return it
+    Move& pickBest();
+    // True if the capture loses material by SEE (put back for the last stage)
+    bool isBadCapture(const Move& move) const;
+    // Already returned by an earlier stage (TT move / killers)
+    bool isSpecialMove(const Move& move) const;
+
+    Board& board;
+    MoveGenerator gen;
+    Move ttMove;
+    Move killerMoves[2];
+    const int (*history)[64];
+    Stage stage;
+    int killerIndex;
+
+    Move moves[220];
+    size_t cur;          // next move to look at in the current stage
+    size_t end;          // end of the current stage
+    size_t badCaptures;  // bad captures are kept in moves[0, badCaptures)
+    size_t badIndex;
+};
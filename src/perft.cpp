@@ -0,0 +1,131 @@
+#include "perft.h"
+#include "gen.hpp"
+#include "move.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace Perft {
+    uint64_t perft(Board &board, int depth) {
+        if (depth <= 0) {
+            return 1;
+        }
+
+        MoveGenerator gen(board, board.sideToMove);
+        Move moves[220];
+        size_t moveCount = gen.generateLegalMoves(moves);
+
+        // Bulk counting at the last ply
+        if (depth == 1) {
+            return moveCount;
+        }
+
+        uint64_t nodes = 0;
+        for (size_t i = 0; i < moveCount; i++) {
+            BoardState state = board.makeMove(moves[i]);
+            nodes += perft(board, depth - 1);
+            board.unmakeMove(moves[i], state);
+        }
+        return nodes;
+    }
+
+    uint64_t divide(Board &board, int depth, std::ostream &os) {
+        MoveGenerator gen(board, board.sideToMove);
+        Move moves[220];
+        size_t moveCount = gen.generateLegalMoves(moves);
+
+        uint64_t total = 0;
+        for (size_t i = 0; i < moveCount; i++) {
+            BoardState state = board.makeMove(moves[i]);
+            uint64_t nodes = perft(board, depth - 1);
+            board.unmakeMove(moves[i], state);
+
+            os << moves[i].toUci() << ": " << nodes << "\n";
+            total += nodes;
+        }
+        os << "\nNodes searched: " << total << std::endl;
+        return total;
+    }
+
+    struct SuiteEntry {
+        const char *fen;
+        int depth;
+        uint64_t nodes;
+    };
+
+    // Reference counts from the Chess Programming Wiki perft results and the
+    // usual collection of move generator edge cases
+    static const SuiteEntry SUITE[] = {
+        // Start position
+        { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6, 119060324ULL },
+        // "Kiwipete": castling, pins, en passant, promotions
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690ULL },
+        // Rook endgame with en passant discovered checks
+        { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083ULL },
+        // Promotions and castling rights lost by capture (and its mirror)
+        { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292ULL },
+        { "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 5, 15833292ULL },
+        // Underpromotion captures
+        { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194ULL },
+        // Quiet middlegame
+        { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551ULL },
+        // Illegal en passant (would expose the king on the rank)
+        { "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888ULL },
+        { "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133ULL },
+        // En passant capture gives check
+        { "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467ULL },
+        // Castling gives check
+        { "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072ULL },
+        { "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711ULL },
+        // Castling rights and attacked castling squares
+        { "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206ULL },
+        { "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476ULL },
+        // Promotion out of check, promotion gives check, underpromotion to check
+        { "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001ULL },
+        { "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342ULL },
+        { "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683ULL },
+        // Self stalemate and stalemate/checkmate detection
+        { "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217ULL },
+        { "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584ULL },
+        // Double check
+        { "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527ULL },
+        { "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658ULL },
+    };
+
+    bool runSuite(std::ostream &os) {
+        bool allPassed = true;
+        uint64_t totalNodes = 0;
+        auto suiteStart = std::chrono::steady_clock::now();
+
+        for (const SuiteEntry &entry : SUITE) {
+            Board board;
+            if (!board.setFromFEN(entry.fen)) {
+                os << "FAILED to parse " << entry.fen << "\n";
+                allPassed = false;
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            uint64_t nodes = perft(board, entry.depth);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            totalNodes += nodes;
+
+            bool passed = (nodes == entry.nodes);
+            allPassed = allPassed && passed;
+            os << (passed ? "ok     " : "FAILED ") << entry.fen << " depth " << entry.depth
+               << " nodes " << nodes;
+            if (!passed) {
+                os << " (expected " << entry.nodes << ")";
+            }
+            os << std::fixed << std::setprecision(2) << " " << nodes / std::max(seconds, 1e-9) / 1e6
+               << " MNPS" << std::endl;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - suiteStart).count();
+        os << "\nTotal nodes: " << totalNodes << ", time: " << std::fixed << std::setprecision(2) << seconds
+           << " s, " << totalNodes / std::max(seconds, 1e-9) / 1e6 << " MNPS\n"
+           << (allPassed ? "All perft counts match" : "Perft suite FAILED") << std::endl;
+        return allPassed;
+    }
+}
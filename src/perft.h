@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include "board.h"
+
+namespace Perft {
+    // Number of leaf nodes depth plies below board
+    // Bulk counting: the last ply only counts the legal moves instead of playing them
+    uint64_t perft(Board &board, int depth);
+
+    // Same as perft, split by root move ("e2e4: 9744"), followed by the total
+    uint64_t divide(Board &board, int depth, std::ostream &os);
+
+    // Runs perft on a suite of standard positions with known node counts (castling,
+    // en passant, promotion and discovered check edge cases included) and prints the
+    // speed in MNPS. Returns true if every count matches
+    bool runSuite(std::ostream &os);
+}
@@ -1,31 +1,132 @@
 #include "search.h"
 #include "eval/evaluate.h"
 #include "gen.hpp"
+#include "movepick.h"
 #include "tt.h"
 #include "zobrist.h"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
-std::chrono::steady_clock::time_point start_time; // Initialize timer
-int time_limit_ms = 9000;                         // 9 seconds
-int rootDepth = 0;                                // Current iteration's root depth
-
-inline bool out_of_time() {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(
-               std::chrono::steady_clock::now() - start_time)
-               .count() >= time_limit_ms;
-}
+// Start of the search clock. Atomic because "ponderhit" restarts it from the UCI thread
+std::atomic<std::chrono::steady_clock::time_point> start_time;
+int time_limit_ms = 9000;                         // 9 seconds, hard limit
+int optimum_time_ms = 0;                          // soft limit between iterations, 0 = none
 
 namespace Search {
 // global stats
 Stats stats;
 Info info;
 
-// Killer moves and history tables
-KillerMoves killers[MAX_PLY];
-int history[64][64] = {0};
+// One ThreadData per search thread, threads[0] is the main thread
+static std::vector<std::unique_ptr<ThreadData>> threads;
+} // namespace Search
+
+// True once the search has to stop: a plain load of the shared stop flag, the
+// clock is only read by checkTime() below
+inline bool out_of_time() {
+    return Search::info.stopped.load(std::memory_order_relaxed);
+}
+
+namespace Search {
+// Main thread node count when start_time was set: the search start, or "ponderhit"
+// which restarts the clock in the middle of the search
+static std::atomic<uint64_t> clockNodeBase{0};
+
+// Called by the main thread at every node. The clock is read only every
+// timeCheckInterval nodes, an interval adapted to the search speed so the
+// polls are about TIME_CHECK_MS apart. Running out of time raises the shared
+// stop flag, so the helper threads and the UCI thread see the same signal
+static void checkTime(ThreadData &td) {
+    if (--td.timeCheckCounter > 0) {
+        return;
+    }
+    
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start_time.load(std::memory_order_relaxed))
+                         .count();
+    // Speed since the clock (re)started, nodes searched while pondering don't count
+    uint64_t nodes = td.stats.nodes.load(std::memory_order_relaxed);
+    uint64_t base = std::min(clockNodeBase.load(std::memory_order_relaxed), nodes);
+    uint64_t nodesPerPoll = (nodes - base) * 1000 * TIME_CHECK_MS / std::max<int64_t>(elapsedUs, 1);
+    td.timeCheckInterval = static_cast<int>(std::clamp<uint64_t>(nodesPerPoll, MIN_TIME_CHECK_NODES, MAX_TIME_CHECK_NODES));
+    td.timeCheckCounter = td.timeCheckInterval;
+    
+    if (info.infinite || info.ponder.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (elapsedUs >= int64_t(time_limit_ms) * 1000) {
+        info.stopped.store(true, std::memory_order_relaxed);
+    }
+}
+
+void ThreadData::clear() {
+    stats.reset();
+    // hash table entries are kept between searches
+    pawnTable.resetStats();
+    materialTable.resetStats();
+    for (int i = 0; i < MAX_PLY; i++) {
+        killers[i].clear();
+        searchPath[i] = 0;
+    }
+    for (int i = 0; i < 64; i++) {
+        for (int j = 0; j < 64; j++) {
+            history[i][j] = 0;
+        }
+    }
+    rootDepth = 0;
+    timeCheckCounter = MIN_TIME_CHECK_NODES;
+    timeCheckInterval = MIN_TIME_CHECK_NODES;
+    bestMove = Move();
+    ponderMove = Move();
+    bestScore = -INFINITY_SCORE;
+    completedDepth = 0;
+}
+
+void setThreadCount(int count) {
+    count = std::max(count, 1);
+    threads.clear();
+    for (int i = 0; i < count; i++) {
+        threads.push_back(std::make_unique<ThreadData>());
+        threads.back()->id = i;
+    }
+}
+
+int threadCount() {
+    return static_cast<int>(threads.size());
+}
+
+void clearEvalCaches() {
+    for (auto &th : threads) {
+        th->evalCache.clear();
+    }
+}
+
+static int multiPVLines = 1;
+
+void setMultiPV(int count) {
+    multiPVLines = std::max(count, 1);
+}
+
+int multiPVCount() {
+    return multiPVLines;
+}
+
+// Sum of the nodes searched by every thread
+static uint64_t totalNodes() {
+    uint64_t nodes = 0;
+    for (const auto &th : threads) {
+        nodes += th->stats.nodes.load(std::memory_order_relaxed);
+    }
+    return nodes;
+}
 
 // Late Move Reduction table
 int reductionTable[LMR_TABLE_SIZE][LMR_TABLE_SIZE];
@@ -40,15 +141,12 @@ void initReductions() {
     }
 }
 
-// Search path tracking for repetition detection
-static uint64_t searchPath[MAX_PLY];
-
 //Check if we have an upcoming repetition
 // Combines game history + search path (unified check)
-inline bool upcoming_repetition(const Board& board, uint64_t hashKey, int ply) {
+inline bool upcoming_repetition(const ThreadData &td, const Board& board, uint64_t hashKey, int ply) {
     // Only check every 2 plies (same side to move)
     for (int i = ply - 2; i >= 0; i -= 2) {
-        if (searchPath[i] == hashKey) {
+        if (td.searchPath[i] == hashKey) {
             return true;
         }
     }
@@ -64,39 +162,63 @@ inline bool upcoming_repetition(const Board& board, uint64_t hashKey, int ply) {
     return false;
 }
 
-// piece values for MVV-LVA
-constexpr int pieceValues[7] = {
-    0,   // EMPTY
-    100, // PAWN
-    300, // KNIGHT
-    300, // BISHOP
-    500, // ROOK
-    900, // QUEEN
-    0    // KING
-};
-
-// move ordering
-int scoreMove(const Move &move, const Board &board, const Stack* stackPtr) {
-    PieceType victim = board.pieceAt(move.to);
-    PieceType attacker = board.pieceAt(move.from);
+// Score in UCI format: "cp <x>" or "mate <moves>" (negative when we are getting mated)
+static std::string scoreToUci(int score) {
+    if (score >= MATE_SCORE - MAX_PLY)
+        return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+    if (score <= -MATE_SCORE + MAX_PLY)
+        return "mate " + std::to_string(-(MATE_SCORE + score) / 2);
+    return "cp " + std::to_string(score);
+}
 
-    // 1. Captures (MVV-LVA) - highest priority
-    if (victim != PieceType::EMPTY) {
-        return 1000000 + 10 * pieceValues[victim] - pieceValues[attacker];
+// Number of leading moves of pv that replay legally from board (restored afterwards)
+// A PV move that isn't legal where it is played is a search bug, the line is cut there
+static int legalPvLength(Board &board, const Move* pv) {
+    BoardState states[MAX_PLY];
+    int length = 0;
+    while (length < MAX_PLY && pv[length].from != pv[length].to) {
+        MoveGenerator gen(board, board.sideToMove);
+        if (!gen.isPseudoLegal(pv[length]) || !gen.isLegal(pv[length])) {
+            break;
+        }
+        states[length] = board.makeMove(pv[length]);
+        length++;
     }
-
-    // 2. Promotions - very high priority
-    if (move.promotion != PieceType::EMPTY) {
-        return 900000 + pieceValues[move.promotion];
+    for (int i = length - 1; i >= 0; i--) {
+        board.unmakeMove(pv[i], states[i]);
     }
+    return length;
+}
 
-    // 3. Killer moves - good quiet moves from sibling nodes
-    if (killers[stackPtr->ply].isKiller(move)) {
-        return 800000;
+// UCI info line of MultiPV line multiPV (1 = best) for a completed iteration, or for
+// an aspiration search that failed ("lowerbound" / "upperbound": the score is only a bound)
+// board is the root position, the PV is checked against it before it is printed
+static void printInfo(Board &board, int depth, size_t multiPV, int score, const Move* pv, const char* bound = nullptr) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start_time.load(std::memory_order_relaxed))
+                       .count();
+    uint64_t nodes = totalNodes();
+    
+    int pvLength = legalPvLength(board, pv);
+    
+    // Built first and written at once, the UCI thread may print "readyok" meanwhile
+    std::ostringstream os;
+    if (pvLength < MAX_PLY && pv[pvLength].from != pv[pvLength].to) {
+        os << "info string illegal PV move " << pv[pvLength].toUci() << " at ply " << pvLength + 1 << "\n";
     }
-
-    // 4. History heuristic - historically good moves
-    return history[move.from][move.to];
+    os << "info depth " << depth
+       << " multipv " << multiPV
+       << " score " << scoreToUci(score) << (bound ? " " : "") << (bound ? bound : "")
+       << " nodes " << nodes
+       << " nps " << (nodes * 1000 / std::max<int64_t>(elapsed, 1))
+       << " hashfull " << TT::tt.hashfull()
+       << " time " << elapsed
+       << " pv";
+    for (int i = 0; i < pvLength; i++) {
+        os << " " << pv[i].toUci();
+    }
+    os << "\n";
+    std::cout << os.str() << std::flush;
 }
 
 int getMateScore(const Stack* stackPtr) {
@@ -121,16 +243,43 @@ inline int value_from_tt(int v, const Stack* stackPtr) {
     return v;
 }
 
+// Static evaluation of the position, taken from the TT entry (ttData, may be null)
+// or from the thread's eval cache when the position was evaluated before
+static int staticEvaluation(ThreadData &td, const Board &board, const TT::TTData *ttData) {
+    td.stats.evalProbes++;
+    uint64_t key = Evaluation::evalKey(board);
+    if (ttData && ttData->eval != TT::EVAL_NONE && key == board.hashKey) {
+        td.stats.evalTTHits++;
+        return ttData->eval;
+    }
+    int eval;
+    if (td.evalCache.probe(key, eval)) {
+        td.stats.evalCacheHits++;
+        return eval;
+    }
+    eval = Evaluation::evaluate(board, td.pawnTable, td.materialTable);
+    td.evalCache.store(key, eval);
+    return eval;
+}
+
+// Static eval for the TT entry of board, which is keyed by Board::hashKey alone:
+// evaluations with a different Evaluation::evalKey are left out
+static int ttEval(const Board &board, int staticEval) {
+    return Evaluation::evalKey(board) == board.hashKey ? staticEval : TT::EVAL_NONE;
+}
+
 // quiescence search - searches only tactical moves (captures/promotions) until quiet
-int quiescence(Board &board, Stack* stackPtr, int alpha, int beta) {
+int quiescence(ThreadData &td, Board &board, Stack* stackPtr, int alpha, int beta) {
     // Prevent stack overflow
     if (stackPtr->ply >= MAX_PLY) {
-        return Evaluation::evaluate(board);
+        return staticEvaluation(td, board, nullptr);
     }
     
     if (out_of_time()) return alpha;
     
-    stats.nodes++;
+    td.stats.addNode();
+    td.stats.qnodes++;
+    if (td.id == 0) checkTime(td);
     
     // Mate distance pruning
     if (stackPtr->ply > 0) {
@@ -146,7 +295,7 @@ int quiescence(Board &board, Stack* stackPtr, int alpha, int beta) {
     }
     
     // get stand-pat score (static evaluation)
-    int standPat = Evaluation::evaluate(board);
+    int standPat = staticEvaluation(td, board, nullptr);
     
     // beta cutoff 
     if (standPat >= beta) {
@@ -162,37 +311,10 @@ int quiescence(Board &board, Stack* stackPtr, int alpha, int beta) {
     // if even capturing a queen can't raise alpha, skip searching
     constexpr int delta = 900;
     
-    // generate all moves
-    MoveGenerator gen(board, board.sideToMove);
-    Move pseudoLegal[220];
-    size_t pseudoLegalCount = gen.generatePseudoLegalMoves(pseudoLegal);
-    Move legalMoves[220];
-    size_t legalCount = gen.filterLegalMoves(pseudoLegal, pseudoLegalCount, legalMoves);
-    
-    // filter to only tactical moves (captures and promotions)
-    Move tacticalMoves[220];
-    size_t tacticalCount = 0;
-    for (size_t i = 0; i < legalCount; i++) {
-        const Move& move = legalMoves[i];
-        PieceType victim = board.pieceAt(move.to);
-        bool isCapture = (victim != PieceType::EMPTY);
-        bool isPromotion = (move.promotion != PieceType::EMPTY);
-        
-        if (isCapture || isPromotion) {
-            tacticalMoves[tacticalCount++] = move;
-        }
-    }
-    
-    // sort tactical moves by MVV-LVA
-    for (size_t i = 0; i < tacticalCount; i++) {
-        tacticalMoves[i].score = scoreMove(tacticalMoves[i], board, stackPtr);
-    }
-    std::sort(tacticalMoves, tacticalMoves + tacticalCount,
-              [](const Move& a, const Move& b) { return a.score > b.score; });
-    
-    // search tactical moves
-    for (size_t i = 0; i < tacticalCount; i++) {
-        const Move& move = tacticalMoves[i];
+    // captures and promotions, best MVV-LVA first
+    MovePicker mp(board);
+    Move move;
+    while (mp.nextMove(move)) {
         if (out_of_time()) break;
         
         // delta pruning - if this capture can't possibly raise alpha, skip it
@@ -206,9 +328,14 @@ int quiescence(Board &board, Stack* stackPtr, int alpha, int beta) {
             }
         }
         
+        // SEE pruning - captures that lose material can't beat the stand-pat
+        if (!board.see(move, 0)) {
+            continue;
+        }
+        
         BoardState state = board.makeMove(move);
         (stackPtr + 1)->ply = stackPtr->ply + 1;
-        int score = -quiescence(board, stackPtr + 1, -beta, -alpha);
+        int score = -quiescence(td, board, stackPtr + 1, -beta, -alpha);
         board.unmakeMove(move, state);
         
         if (out_of_time()) break;
@@ -227,7 +354,7 @@ int quiescence(Board &board, Stack* stackPtr, int alpha, int beta) {
 
 // alpha-beta search with TT integration
 template<NodeType NT>
-int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut) {
+int alphaBeta(ThreadData &td, Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut) {
     // Determine node type at compile time
     constexpr bool pvNode = (NT == PV || NT == Root);
     constexpr bool rootNode = (NT == Root);
@@ -238,7 +365,7 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
     
     // Extend search when we're in check to find escapes
     bool inCheck = board.isKingInCheck(board.sideToMove);
-    if (inCheck && depth <= 0 && stackPtr->ply < 2 * rootDepth) {
+    if (inCheck && depth <= 0 && stackPtr->ply < 2 * td.rootDepth) {
         depth = 1;
     }
     
@@ -248,13 +375,14 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
     int originalAlpha = alpha;
     uint64_t hashKey = board.hashKey;
     
-    stats.nodes++;
+    td.stats.addNode();
+    if (td.id == 0) checkTime(td);
     
     // Store position in search path for repetition detection
-    searchPath[stackPtr->ply] = hashKey;
+    td.searchPath[stackPtr->ply] = hashKey;
     
     // Prevent TT from suggesting moves that lead to repetition
-    if (stackPtr->ply > 0 && upcoming_repetition(board, hashKey, stackPtr->ply)) {
+    if (stackPtr->ply > 0 && upcoming_repetition(td, board, hashKey, stackPtr->ply)) {
         // Return draw score
         return 0;
     }
@@ -273,45 +401,46 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
     }
     
     // Probe transposition table
-    TT::TTEntry* ttEntry = TT::tt.probe(hashKey);
+    TT::TTData ttData;
+    bool ttHit = TT::tt.probe(hashKey, ttData);
     Move ttMove;
     
     // Track TT hit
-    stackPtr->ttHit = (ttEntry != nullptr);
+    stackPtr->ttHit = ttHit;
     stackPtr->ttPv = false;
     
     // TT CUTOFFS only at NON-PV nodes
     // PV nodes (root and expected best line) always get full search
-    if (!pvNode && ttEntry != nullptr && ttEntry->depth >= depth) {
-        ttMove = ttEntry->bestMove;
+    if (!pvNode && ttHit && ttData.depth >= depth) {
+        ttMove = ttData.bestMove;
         
         // Adjust mate scores from TT
-        int ttValue = value_from_tt(ttEntry->value, stackPtr);
+        int ttValue = value_from_tt(ttData.value, stackPtr);
         
-        if (ttEntry->type == TT::EXACT) {
+        if (ttData.type() == TT::EXACT) {
             if (bestMoveOut) *bestMoveOut = ttMove;
             return ttValue;
-        } else if (ttEntry->type == TT::LOWERBOUND) {
+        } else if (ttData.type() == TT::LOWERBOUND) {
             if (ttValue >= beta) {
                 if (bestMoveOut) *bestMoveOut = ttMove;
                 return beta;
             }
             alpha = std::max(alpha, ttValue);
-        } else if (ttEntry->type == TT::UPPERBOUND) {
+        } else if (ttData.type() == TT::UPPERBOUND) {
             if (ttValue <= alpha) {
                 if (bestMoveOut) *bestMoveOut = ttMove;
                 return alpha;
             }
             beta = std::min(beta, ttValue);
         }
-    } else if (ttEntry != nullptr) {
+    } else if (ttHit) {
         // TT hit but insufficient depth - still use for move ordering
-        ttMove = ttEntry->bestMove;
+        ttMove = ttData.bestMove;
     }
     
     // terminal node - quiescence search
     if (depth == 0) {
-        return quiescence(board, stackPtr, alpha, beta);
+        return quiescence(td, board, stackPtr, alpha, beta);
     }
     
     
@@ -321,12 +450,16 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
                       board.bitboards[board.sideToMove][ROOK] == 0 &&
                       board.bitboards[board.sideToMove][QUEEN] == 0);
     
+    // Static eval, only computed when a pruning decision needs it
+    // Stored with the TT entry of this node so the next visit doesn't recompute it
+    int staticEval = TT::EVAL_NONE;
+    
     // Null move pruning
     // Check previous move wasn't null (don't do two null moves in a row)
     bool prevMoveWasNull = (stackPtr - 1)->currentMove.isNull();
     if (depth >= 3 && !pvNode && !prevMoveWasNull && !inEndgame && !board.isKingInCheck(board.sideToMove)) {
         // Evaluate current position
-        int staticEval = Evaluation::evaluate(board);
+        staticEval = staticEvaluation(td, board, ttHit ? &ttData : nullptr);
         
         // Only try NMP if we're in a good position
         if (staticEval >= beta) {
@@ -337,12 +470,13 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
             
             // Make null move
             board.makeNullMove();
+            TT::tt.prefetch(board.hashKey);
             
             // Search with reduced depth
             (stackPtr + 1)->ply = stackPtr->ply + 1;
             (stackPtr + 1)->reduction = 0;
             (stackPtr + 1)->currentMove = Move::null();  // Mark as null move in stack
-            int nullScore = -alphaBeta<NonPV>(board, stackPtr + 1, depth - R - 1 , -beta, -beta + 1, !cutNode, nullptr);
+            int nullScore = -alphaBeta<NonPV>(td, board, stackPtr + 1, depth - R - 1 , -beta, -beta + 1, !cutNode, nullptr);
             
             // Unmake null move
             board.unmakeNullMove();
@@ -365,63 +499,48 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
         depth--;
     }
     
-    // generate moves
-    MoveGenerator gen(board, board.sideToMove);
-    Move pseudoLegal[220];
-    size_t pseudoLegalCount = gen.generatePseudoLegalMoves(pseudoLegal);
-    Move legalMoves[220];
-    size_t legalCount = gen.filterLegalMoves(pseudoLegal, pseudoLegalCount, legalMoves);
-    
-    // sort moves with score (TT move > Captures > Killers > History)
-    for (size_t i = 0; i < legalCount; i++) {
-        Move &move = legalMoves[i];
-        // Give TT move highest priority
-        if (ttMove.from != 0 && move.from == ttMove.from && move.to == ttMove.to && 
-            move.promotion == ttMove.promotion) {
-            move.score = 2000000;
-        } else {
-            move.score = scoreMove(move, board, stackPtr);
-        }
-    }
-    std::sort(legalMoves, legalMoves + legalCount,
-              [](const Move &a, const Move &b) { return a.score > b.score; });
-    
-    // check for checkmate/stalemate
-    if (legalCount == 0) {
-        if (board.isKingInCheck(board.sideToMove)) {
-            // checkmate - return mate score adjusted by ply
-            return getMateScore(stackPtr);
-        } else {
-            // stalemate
-            return 0;
-        }
-    }
-    
     // alpha-beta loop
+    // moves come from the staged picker (TT move > Captures > Killers > History),
+    // which only generates and legality checks them as they are needed
+    MovePicker mp(board, ttMove, td.killers[stackPtr->ply], td.history);
     int bestScore = -INFINITY_SCORE;
-    Move bestMove = legalMoves[0];
+    Move bestMove;
     int moveCount = 0;
     
     // Child PV array
     Move childPv[MAX_PLY];
     
-    for (size_t i = 0; i < legalCount; i++) {
-        const Move &move = legalMoves[i];
-        if (out_of_time()) break;
-        
+    Move move;
+    while (mp.nextMove(move)) {
         moveCount++;
+        if (out_of_time()) break;
         
         // Check if this is a tactical move (capture or promotion)
         PieceType victim = board.pieceAt(move.to);
         bool isCapture = (victim != PieceType::EMPTY);
         bool isPromotion = (move.promotion != PieceType::EMPTY);
         
+        // SEE pruning - at shallow depth skip moves that lose too much material
+        // on their target square, the margin grows with the remaining depth
+        // Checks are still searched, so the decision is applied after makeMove
+        bool seePrunable = !rootNode && !inCheck && !inEndgame && depth <= SEE_PRUNING_DEPTH
+                           && bestScore > -MATE_SCORE + MAX_PLY
+                           && !board.see(move, (isCapture || isPromotion) ? -SEE_CAPTURE_MARGIN * depth
+                                                                          : -SEE_QUIET_MARGIN * depth * depth);
+        
         // make/unmake method (efficient - no board copying)
         BoardState state = board.makeMove(move);
+        // Start loading the child's TT cluster now, the check detection and
+        // stack setup below run while it is in flight
+        TT::tt.prefetch(board.hashKey);
         
         // Extend depth if move gives a check, improves probability of finding mate
         bool givesCheck = board.isKingInCheck(board.sideToMove);
-        int extension = (givesCheck && stackPtr->ply < 2 * rootDepth) ? 1 : 0;
+        if (seePrunable && !givesCheck) {
+            board.unmakeMove(move, state);
+            continue;
+        }
+        int extension = (givesCheck && stackPtr->ply < 2 * td.rootDepth) ? 1 : 0;
         
         // Set up child stack
         (stackPtr + 1)->ply = stackPtr->ply + 1;
@@ -447,9 +566,9 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
         if (moveCount == 1) {
             (stackPtr + 1)->reduction = 0;
             if (childPvNode)
-                score = -alphaBeta<PV>(board, stackPtr + 1, newdepth, -beta, -alpha, false, nullptr);
+                score = -alphaBeta<PV>(td, board, stackPtr + 1, newdepth, -beta, -alpha, false, nullptr);
             else
-                score = -alphaBeta<NonPV>(board, stackPtr + 1, newdepth, -beta, -alpha, childCutNode, nullptr);
+                score = -alphaBeta<NonPV>(td, board, stackPtr + 1, newdepth, -beta, -alpha, childCutNode, nullptr);
         }
         // Later moves: use LMR with re-search
         else {
@@ -469,23 +588,23 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
             // Step 1: Search with reduced depth and null window
             if (reduction > 0) {
                 (stackPtr + 1)->reduction = reduction;
-                score = -alphaBeta<NonPV>(board, stackPtr + 1, newdepth - reduction, -(alpha + 1), -alpha, childCutNode, nullptr);
+                score = -alphaBeta<NonPV>(td, board, stackPtr + 1, newdepth - reduction, -(alpha + 1), -alpha, childCutNode, nullptr);
             } else {
                 // No reduction: just null window search (PVS)
                 (stackPtr + 1)->reduction = 0;
-                score = -alphaBeta<NonPV>(board, stackPtr + 1, newdepth, -(alpha + 1), -alpha, childCutNode, nullptr);
+                score = -alphaBeta<NonPV>(td, board, stackPtr + 1, newdepth, -(alpha + 1), -alpha, childCutNode, nullptr);
             }
             
             // Step 2: If reduced search failed high, re-search at full depth with null window
             if (reduction > 0 && score > alpha) {
                 (stackPtr + 1)->reduction = 0;
-                score = -alphaBeta<NonPV>(board, stackPtr + 1, newdepth, -(alpha + 1), -alpha, childCutNode, nullptr);
+                score = -alphaBeta<NonPV>(td, board, stackPtr + 1, newdepth, -(alpha + 1), -alpha, childCutNode, nullptr);
             }
             
             // Step 3: If still failed high and we're in PV node, re-search with full window
             if (score > alpha && score < beta && pvNode) {
                 (stackPtr + 1)->reduction = 0;
-                score = -alphaBeta<PV>(board, stackPtr + 1, newdepth, -beta, -alpha, false, nullptr);
+                score = -alphaBeta<PV>(td, board, stackPtr + 1, newdepth, -beta, -alpha, false, nullptr);
             }
         }
         
@@ -501,12 +620,15 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
             bestMove = move;
             
             // Update PV: current move + child's PV
+            // The child PV ends at an empty move (from == to, a move from a1 is valid),
+            // which is copied too so no tail of an older, longer PV survives
             if (stackPtr->pv) {
                 stackPtr->pv[0] = move;
-                for (int i = 0; i < MAX_PLY - 1 && childPv[i].from != 0; i++) {
+                int i = 0;
+                for (; i < MAX_PLY - 2 && childPv[i].from != childPv[i].to; i++) {
                     stackPtr->pv[i + 1] = childPv[i];
                 }
-                stackPtr->pv[MAX_PLY - 1] = Move();
+                stackPtr->pv[i + 1] = Move();
             }
         }
         
@@ -516,20 +638,20 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
             // Update killer moves and history for quiet moves
             if (!isCapture && !isPromotion) {
                 // Killer moves: store quiet move that caused cutoff
-                killers[stackPtr->ply].add(move);
+                td.killers[stackPtr->ply].add(move);
                 
                 // History heuristic: reward with depth² bonus
                 int bonus = depth * depth;
-                history[move.from][move.to] += bonus;
+                td.history[move.from][move.to] += bonus;
                 // Cap to prevent overflow
-                if (history[move.from][move.to] > HISTORY_MAX) {
-                    history[move.from][move.to] = HISTORY_MAX;
+                if (td.history[move.from][move.to] > HISTORY_MAX) {
+                    td.history[move.from][move.to] = HISTORY_MAX;
                 }
             }
             
             // Store in TT as LOWERBOUND (beta cutoff)
             int ttScore = value_to_tt(bestScore, stackPtr);
-            TT::tt.store(hashKey, ttScore, depth, TT::LOWERBOUND, bestMove);
+            TT::tt.store(hashKey, ttScore, depth, TT::LOWERBOUND, bestMove, ttEval(board, staticEval));
             if (bestMoveOut) *bestMoveOut = bestMove;
             return beta; // fail-high cutoff
         }
@@ -540,6 +662,17 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
         }
     }
     
+    // check for checkmate/stalemate
+    if (moveCount == 0) {
+        if (board.isKingInCheck(board.sideToMove)) {
+            // checkmate - return mate score adjusted by ply
+            return getMateScore(stackPtr);
+        } else {
+            // stalemate
+            return 0;
+        }
+    }
+    
     // Determine node type and store in TT
     TT::NodeType nodeType;
     if (bestScore <= originalAlpha) {
@@ -552,44 +685,88 @@ int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, boo
     
     // Adjust mate scores for TT storage
     int ttScore = value_to_tt(bestScore, stackPtr);
-    TT::tt.store(hashKey, ttScore, depth, nodeType, bestMove);
+    TT::tt.store(hashKey, ttScore, depth, nodeType, bestMove, ttEval(board, staticEval));
     
     if (bestMoveOut) *bestMoveOut = bestMove;
     return bestScore;
 }
 
-// main search function with TT integration
-Move findBestMove(Board &board, int depth) {
-    stats.reset();
-    info.reset();
-    info.maxDepth = depth;
-    
-    // Initialize LMR reduction table
-    static bool reductionsInitialized = false;
-    if (!reductionsInitialized) {
-        initReductions();
-        reductionsInitialized = true;
-    }
-    
-    // Increment TT generation for new search
-    TT::tt.new_search();
-    
-    // Clear killer moves for new search
-    for (int i = 0; i < MAX_PLY; i++) {
-        killers[i].clear();
-    }
+// Lazy SMP depth skipping for helper threads, so that the threads spread over
+// different iterations instead of all searching the same depth at the same time
+constexpr int SKIP_SIZE[]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+constexpr int SKIP_PHASE[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+// Searches the root moves [pvIdx, end) of td.rootMoves with the window [alpha, beta]
+// The first of them gets the full window, the others a null window first (PVS) and
+// the full window only when they beat alpha. Moves better than the ones before
+// pvIdx aren't searched again, that is how MultiPV excludes the better lines.
+// A move scoring above alpha gets its score and PV, the others -INFINITY_SCORE
+// (the first move keeps its bound), then [pvIdx, end) is sorted best first.
+// Returns the best score (a bound when outside the window)
+static int searchRoot(ThreadData &td, Board &board, Stack* stackPtr, int depth, size_t pvIdx,
+                      int alpha, int beta) {
+    int bestScore = -INFINITY_SCORE;
     
-    // Clear history table for new search
-    for (int i = 0; i < 64; i++) {
-        for (int j = 0; j < 64; j++) {
-            history[i][j] = 0;
+    for (size_t i = pvIdx; i < td.rootMoves.size(); i++) {
+        RootMove &rm = td.rootMoves[i];
+        if (out_of_time()) break;
+        
+        // Child PV for this move
+        Move childPv[MAX_PLY];
+        for (int j = 0; j < MAX_PLY; j++) childPv[j] = Move();
+        
+        uint64_t nodesAtStart = td.stats.nodes.load(std::memory_order_relaxed);
+        BoardState state = board.makeMove(rm.move);
+        TT::tt.prefetch(board.hashKey);
+        // Set up child stack for root search
+        (stackPtr + 1)->ply = 1;
+        (stackPtr + 1)->pv = childPv;
+        (stackPtr + 1)->reduction = 0;
+        (stackPtr + 1)->currentMove = rm.move;
+        
+        int score;
+        if (i == pvIdx) {
+            score = -alphaBeta<PV>(td, board, stackPtr + 1, depth - 1, -beta, -alpha, false, nullptr);
+        } else {
+            score = -alphaBeta<NonPV>(td, board, stackPtr + 1, depth - 1, -(alpha + 1), -alpha, true, nullptr);
+            if (score > alpha) {
+                score = -alphaBeta<PV>(td, board, stackPtr + 1, depth - 1, -beta, -alpha, false, nullptr);
+            }
+        }
+        board.unmakeMove(rm.move, state);
+        
+        if (out_of_time()) break;
+        
+        rm.nodes += td.stats.nodes.load(std::memory_order_relaxed) - nodesAtStart;
+        bestScore = std::max(bestScore, score);
+        
+        if (i == pvIdx || score > alpha) {
+            rm.score = score;
+            rm.pv[0] = rm.move;
+            for (int j = 0; j < MAX_PLY - 1; j++) {
+                rm.pv[j + 1] = childPv[j];
+                if (childPv[j].from == childPv[j].to) break;
+            }
+        } else {
+            rm.score = -INFINITY_SCORE;
+        }
+        
+        if (score > alpha) {
+            alpha = score;
+            if (score >= beta) {
+                break;
+            }
         }
     }
     
-    // Clear search path for repetition detection
-    for (int i = 0; i < MAX_PLY; i++) {
-        searchPath[i] = 0;
-    }
+    // Stable: moves that didn't beat alpha keep their order
+    std::stable_sort(td.rootMoves.begin() + pvIdx, td.rootMoves.end());
+    return bestScore;
+}
+
+// iterative deepening loop run by every search thread on its own copy of the board
+static void iterativeDeepening(ThreadData &td, Board &board, int depth) {
+    const bool mainThread = (td.id == 0);
     
     // Initialize search stack. Root is at stackPtr[7].
     // Allocate extra space to allow access from (stackPtr-7) to (stackPtr+2)
@@ -602,152 +779,298 @@ Move findBestMove(Board &board, int depth) {
         (stackPtr + i)->reduction = 0;
     }
     
-    start_time = std::chrono::steady_clock::now();
-    
-    // generate root moves
-    MoveGenerator gen(board, board.sideToMove);
-    Move pseudoLegal[220];
-    size_t pseudoLegalCount = gen.generatePseudoLegalMoves(pseudoLegal);
-    Move legalMoves[220];
-    size_t legalCount = gen.filterLegalMoves(pseudoLegal, pseudoLegalCount, legalMoves);
-    
     // Check TT for move ordering
     uint64_t hashKey = board.hashKey;
-    TT::TTEntry* ttEntry = TT::tt.probe(hashKey);
-    
-    // sort moves with score (TT > Captures > Killers > History)
-    for (size_t i = 0; i < legalCount; i++) {
-        Move &move = legalMoves[i];
-        // Give TT move highest priority
-        if (ttEntry && ttEntry->bestMove.from != 0 && 
-            move.from == ttEntry->bestMove.from && 
-            move.to == ttEntry->bestMove.to &&
-            move.promotion == ttEntry->bestMove.promotion) {
-            move.score = 2000000;  // TT move - highest priority
-        } else {
-            move.score = scoreMove(move, board, stackPtr);  // stackPtr->ply = 0 at root
-        }
+    TT::TTData ttData;
+    bool ttHit = TT::tt.probe(hashKey, ttData);
+    Move ttMove = ttHit ? ttData.bestMove : Move();
+    
+    // generate root moves, in picker order (TT > Captures > Killers > History)
+    // the root list is kept between iterations and re-sorted by score after every search
+    MovePicker mp(board, ttMove, td.killers[stackPtr->ply], td.history);
+    td.rootMoves.clear();
+    Move move;
+    while (mp.nextMove(move)) {
+        td.rootMoves.emplace_back(move);
     }
-    std::sort(legalMoves, legalMoves + legalCount,
-              [](const Move &a, const Move &b) { return a.score > b.score; });
     
-    if (legalCount == 0) {
-        return Move(); // no legal moves (checkmate or stalemate), return empty move
+    if (td.rootMoves.empty()) {
+        return; // no legal moves (checkmate or stalemate), td.bestMove stays empty
     }
     
-    Move bestMove = legalMoves[0];
-    int bestScore = -INFINITY_SCORE;
+    td.bestMove = td.rootMoves[0].move;
+    const size_t multiPV = std::min<size_t>(multiPVCount(), td.rootMoves.size());
     
-    // PV from previous iteration
-    Move previousPv[MAX_PLY];
-    for (int i = 0; i < MAX_PLY; i++) previousPv[i] = Move();
+    // Time management state (main thread): best move changes (decaying average),
+    // previous iteration score and duration
+    double bestMoveChanges = 0.0;
+    int previousScore = -INFINITY_SCORE;
+    int64_t previousIterationMs = 0;
     
     // Iterative deepening
     for (int currentDepth = 1; currentDepth <= depth; currentDepth++) {
-        rootDepth = currentDepth;  // Store for check extension limits
-        auto layer_start = std::chrono::steady_clock::now(); // Timing a depth
-        uint64_t nodesAtStart = stats.nodes;
-        
-        int alpha = -INFINITY_SCORE;
-        int beta = INFINITY_SCORE;
-        
-        Move bestMoveThisIter = legalMoves[0];
-        int bestScoreThisIter = -INFINITY_SCORE;
-        
-        // PV for current iteration
-        Move currentPv[MAX_PLY];
-        for (int i = 0; i < MAX_PLY; i++) currentPv[i] = Move();
-        
-        // Re-sort moves using PV from previous iteration
-        if (currentDepth > 1 && previousPv[0].from != 0) {
-            for (size_t i = 0; i < legalCount; i++) {
-                Move &move = legalMoves[i];
-                // PV move from previous iteration gets highest priority
-                if (move.from == previousPv[0].from && move.to == previousPv[0].to &&
-                    move.promotion == previousPv[0].promotion) {
-                    move.score = 3000000;
-                }
+        // Helper threads skip some depths so they don't all search the same iteration
+        if (!mainThread) {
+            int i = (td.id - 1) % 20;
+            if (((currentDepth + SKIP_PHASE[i]) / SKIP_SIZE[i]) % 2) {
+                continue;
             }
-            std::sort(legalMoves, legalMoves + legalCount,
-                      [](const Move &a, const Move &b) { return a.score > b.score; });
         }
         
-        for (size_t i = 0; i < legalCount; i++) {
-            const Move &move = legalMoves[i];
-            if (out_of_time()) break;   
-
-            // Child PV for this move
-            Move childPv[MAX_PLY];
-            for (int i = 0; i < MAX_PLY; i++) childPv[i] = Move();
-            
-            BoardState state = board.makeMove(move);
-            // Set up child stack for root search
-            (stackPtr + 1)->ply = 1;
-            (stackPtr + 1)->pv = childPv;
-            (stackPtr + 1)->reduction = 0;
-            (stackPtr + 1)->currentMove = move;
-            // Root is always PV node, never a cut node
-            int score = -alphaBeta<PV>(board, stackPtr + 1, currentDepth - 1, -beta, -alpha, false, nullptr);
-            board.unmakeMove(move, state);
-            
-            if (out_of_time()) break;
+        td.rootDepth = currentDepth;  // Store for check extension limits
+        auto layer_start = std::chrono::steady_clock::now(); // Timing a depth
+        uint64_t nodesAtStart = totalNodes();
+        uint64_t threadNodesAtStart = td.stats.nodes.load(std::memory_order_relaxed);
+        Move previousBest = td.rootMoves[0].move;
+        
+        // Scores of moves not searched again in this iteration must not count
+        for (RootMove &rm : td.rootMoves) {
+            rm.previousScore = rm.score;
+            rm.score = -INFINITY_SCORE;
+            rm.nodes = 0;
+        }
+        
+        // MultiPV: line k searches the root without the k - 1 better moves found before
+        for (size_t pvIdx = 0; pvIdx < multiPV && !out_of_time(); pvIdx++) {
+            // Aspiration window: from ASPIRATION_MIN_DEPTH on, the root is searched with a
+            // narrow window around the line's previous score. When the score falls outside,
+            // the window is widened on that side and the root searched again
+            int lineScore = td.rootMoves[pvIdx].previousScore;
+            int delta = ASPIRATION_DELTA;
+            int alpha = -INFINITY_SCORE;
+            int beta = INFINITY_SCORE;
+            if (currentDepth >= ASPIRATION_MIN_DEPTH && std::abs(lineScore) < MATE_SCORE - MAX_PLY) {
+                alpha = std::max(lineScore - delta, -INFINITY_SCORE);
+                beta = std::min(lineScore + delta, INFINITY_SCORE);
+            }
             
-            if (score > bestScoreThisIter) {
-                bestScoreThisIter = score;
-                bestMoveThisIter = move;
+            while (true) {
+                int score = searchRoot(td, board, stackPtr, currentDepth, pvIdx, alpha, beta);
+                if (out_of_time()) break;
                 
-                // Update current iteration's PV
-                currentPv[0] = move;
-                for (int i = 0; i < MAX_PLY - 1 && childPv[i].from != 0; i++) {
-                    currentPv[i + 1] = childPv[i];
+                if (score <= alpha) {
+                    // Fail low: the line's move stays first, lower alpha (and beta a bit with it)
+                    if (mainThread) {
+                        printInfo(board, currentDepth, pvIdx + 1, score, td.rootMoves[pvIdx].pv, "upperbound");
+                    }
+                    beta = (alpha + beta) / 2;
+                    alpha = std::max(score - delta, -INFINITY_SCORE);
+                } else if (score >= beta) {
+                    // Fail high: the move that reached beta is sorted first and is already
+                    // the best move should the time run out
+                    if (mainThread) {
+                        printInfo(board, currentDepth, pvIdx + 1, score, td.rootMoves[pvIdx].pv, "lowerbound");
+                    }
+                    beta = std::min(score + delta, INFINITY_SCORE);
+                } else {
+                    break;
                 }
+                delta += delta / 2;
             }
             
-            if (score > alpha) {
-                alpha = score;
-            }
+            // Keep the lines found so far in order
+            std::stable_sort(td.rootMoves.begin(), td.rootMoves.begin() + pvIdx + 1);
         }
         
-        auto layer_end = std::chrono::steady_clock::now();
-        auto layer_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            layer_end - layer_start)
-                            .count();
-        
-        // Calculate nodes searched this depth
-        uint64_t nodesThisDepth = stats.nodes - nodesAtStart;
+        const RootMove &best = td.rootMoves[0];
         
-        std::cout << "Depth " << currentDepth
-                  << " took " << layer_ms << " ms"
-                  << " (nodes: " << nodesThisDepth << ")\n";
+        if (mainThread) {
+            auto layer_end = std::chrono::steady_clock::now();
+            auto layer_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                layer_end - layer_start)
+                                .count();
+            
+            // Calculate nodes searched this depth (all threads)
+            uint64_t nodesThisDepth = totalNodes() - nodesAtStart;
+            
+            std::cout << "Depth " << currentDepth
+                      << " took " << layer_ms << " ms"
+                      << " (nodes: " << nodesThisDepth << ")\n";
+        }
         
         if (out_of_time()) {
-            std::cout << "Time limit reached after depth " << currentDepth << "\n";
+            if (mainThread) {
+                std::cout << "Time limit reached after depth " << currentDepth << "\n";
+            }
+            // Keep the part of the iteration that was searched: the list is sorted by what
+            // was finished, so a root move that beat the previous best is first now
+            if (currentDepth > 1 && best.score != -INFINITY_SCORE) {
+                td.bestMove = best.move;
+                td.bestScore = best.score;
+                td.ponderMove = best.pv[1];
+            }
             break;
         }
         
-        // Depth completed, update global best move and PV
-        bestMove = bestMoveThisIter;
-        bestScore = bestScoreThisIter;
-        stats.depthReached = currentDepth;
+        // Depth completed, update this thread's best move and PV
+        td.bestMove = best.move;
+        td.ponderMove = best.pv[1];
+        td.bestScore = best.score;
+        td.completedDepth = currentDepth;
         
-        // Copy current PV to previous PV for next iteration 
-        for (int i = 0; i < MAX_PLY; i++) {
-            previousPv[i] = currentPv[i];
+        if (mainThread) {
+            for (size_t k = 0; k < multiPV; k++) {
+                printInfo(board, currentDepth, k + 1, td.rootMoves[k].score, td.rootMoves[k].pv);
+            }
         }
         
         // Stop searching if we found a forced checkmate
-        if (bestScoreThisIter >= MATE_SCORE - MAX_PLY) {
-            std::cout << "Forced checkmate found at depth " << currentDepth << "\n";
+        if (best.score >= MATE_SCORE - MAX_PLY) {
+            if (mainThread) {
+                std::cout << "Forced checkmate found at depth " << currentDepth << "\n";
+            }
             break;
         }
+        
+        // Soft time limit, checked by the main thread between iterations
+        // The optimum time is stretched when the best move keeps changing or the score
+        // drops, and shrunk when the best move takes almost all of the nodes
+        int64_t iterationMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  std::chrono::steady_clock::now() - layer_start)
+                                  .count();
+        // One change at most per iteration: the aspiration re-searches of the best line
+        // would count the same replacement again after every fail
+        bool bestMoveChanged = currentDepth > 1 && !KillerMoves::sameMove(best.move, previousBest);
+        bestMoveChanges = bestMoveChanges / 2 + (bestMoveChanged ? 1 : 0);
+        if (mainThread && optimum_time_ms > 0 && !info.infinite && !info.ponder.load(std::memory_order_relaxed)) {
+            uint64_t iterationNodes = td.stats.nodes.load(std::memory_order_relaxed) - threadNodesAtStart;
+            double bestMoveEffort = double(best.nodes) / std::max<uint64_t>(iterationNodes, 1);
+            
+            double instability = 1.0 + 1.5 * bestMoveChanges;
+            double fallingEval = previousScore == -INFINITY_SCORE
+                                     ? 1.0
+                                     : std::clamp(1.0 + (previousScore - best.score) / 200.0, 0.75, 1.5);
+            double nodeEffort = std::clamp(1.6 - 1.2 * bestMoveEffort, 0.5, 1.4);
+            
+            double softLimit = std::min<double>(optimum_time_ms * instability * fallingEval * nodeEffort, time_limit_ms);
+            int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  std::chrono::steady_clock::now() - start_time.load(std::memory_order_relaxed))
+                                  .count();
+            
+            // Don't start an iteration that can't plausibly finish before the hard
+            // limit: the next one takes about as much longer as this one did over the last
+            double growth = previousIterationMs > 0 ? std::clamp(double(iterationMs) / previousIterationMs, 1.5, 4.0) : 2.0;
+            double nextIterationMs = iterationMs * growth;
+            
+            if (elapsed >= softLimit || elapsed + nextIterationMs > time_limit_ms) {
+                info.stopped = true;
+                break;
+            }
+        }
+        previousScore = best.score;
+        previousIterationMs = iterationMs;
+    }
+}
+
+// main search function with TT integration
+// Lazy SMP: every thread runs its own iterative deepening on a copy of the board
+// and they only communicate through the shared transposition table
+Move findBestMove(Board &board, int depth, Move* ponderMove) {
+    stats.reset();
+    info.reset();
+    info.maxDepth = depth;
+    
+    // Initialize LMR reduction table
+    static bool reductionsInitialized = false;
+    if (!reductionsInitialized) {
+        initReductions();
+        reductionsInitialized = true;
     }
     
-    return bestMove;
+    if (threads.empty()) {
+        setThreadCount(1);
+    }
+    
+    // Increment TT generation for new search
+    TT::tt.new_search();
+    
+    // Clear killers, history and search path of every thread
+    for (auto &th : threads) {
+        th->clear();
+    }
+    
+    clockNodeBase.store(0, std::memory_order_relaxed);
+    start_time.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
+    
+    // Start helper threads, each one searches its own copy of the board
+    std::vector<Board> helperBoards(threads.size() - 1, board);
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threads.size(); i++) {
+        helpers.emplace_back(iterativeDeepening, std::ref(*threads[i]), std::ref(helperBoards[i - 1]), depth);
+    }
+    
+    // Main thread search
+    ThreadData &mainTd = *threads[0];
+    iterativeDeepening(mainTd, board, depth);
+    
+    // While pondering or in infinite mode the bestmove may only be sent after "stop"
+    // or "ponderhit", even when the search ended early (depth limit, forced mate)
+    while (!info.stopped && (info.ponder || info.infinite)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    // Main thread is done, stop the helpers and wait for them
+    info.stopped = true;
+    for (auto &helper : helpers) {
+        helper.join();
+    }
+    
+    // Pick the best completed result: a helper is preferred when it finished
+    // a deeper iteration with a better score than the current choice
+    ThreadData *bestThread = &mainTd;
+    for (size_t i = 1; i < threads.size(); i++) {
+        ThreadData *th = threads[i].get();
+        if (th->completedDepth > bestThread->completedDepth && th->bestScore > bestThread->bestScore) {
+            bestThread = th;
+        }
+    }
+    
+    // Aggregate stats over all threads
+    stats.nodes = totalNodes();
+    for (const auto &th : threads) {
+        stats.qnodes += th->stats.qnodes;
+        stats.pawnProbes += th->pawnTable.probes;
+        stats.pawnHits += th->pawnTable.hits;
+        stats.materialProbes += th->materialTable.probes;
+        stats.materialHits += th->materialTable.hits;
+        stats.evalProbes += th->stats.evalProbes;
+        stats.evalTTHits += th->stats.evalTTHits;
+        stats.evalCacheHits += th->stats.evalCacheHits;
+    }
+    stats.depthReached = bestThread->completedDepth;
+    
+    if (ponderMove) {
+        *ponderMove = bestThread->ponderMove;
+        // PV cut short (e.g. by a TT cutoff at the root's child): take the reply from the TT
+        if (ponderMove->from == ponderMove->to && bestThread->bestMove.from != bestThread->bestMove.to) {
+            BoardState state = board.makeMove(bestThread->bestMove);
+            TT::TTData ttData;
+            if (TT::tt.probe(board.hashKey, ttData)) {
+                MoveGenerator gen(board, board.sideToMove);
+                if (gen.isPseudoLegal(ttData.bestMove) && gen.isLegal(ttData.bestMove)) {
+                    *ponderMove = ttData.bestMove;
+                }
+            }
+            board.unmakeMove(bestThread->bestMove, state);
+        }
+    }
+    
+    return bestThread->bestMove;
+}
+
+void ponderhit() {
+    // Our clock starts now, the time spent pondering was the opponent's
+    // The node base goes first: a poll in between only sees a lower speed (more polls)
+    if (!threads.empty()) {
+        clockNodeBase.store(threads[0]->stats.nodes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    start_time.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
+    info.ponder = false;
 }
 
 // Explicit template instantiations
-template int alphaBeta<NonPV>(Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut);
-template int alphaBeta<PV>(Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut);
-template int alphaBeta<Root>(Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut);
+template int alphaBeta<NonPV>(ThreadData &td, Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut);
+template int alphaBeta<PV>(ThreadData &td, Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut);
+template int alphaBeta<Root>(ThreadData &td, Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut);
 
 } // namespace Search
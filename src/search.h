@@ -2,7 +2,10 @@
 #include "board.h"
 #include "move.h"
 #include "tt.h"
+#include "eval/evaluate.h"
+#include <atomic>
 #include <cstdint>
+#include <vector>
 
 namespace Search {
 // Node types for search template parameter
@@ -24,14 +27,38 @@ constexpr int MAX_PLY = 64;
 
 // search stats
 struct Stats {
-    // number of nodes searched
-    uint64_t nodes;
+    // number of nodes searched (relaxed atomic so other threads can sum it mid-search)
+    std::atomic<uint64_t> nodes;
+    // of which quiescence search nodes (summed over the threads after the search)
+    uint64_t qnodes;
     // depth reached
     int depthReached;
+    // pawn / material hash table probes and hits (summed over the threads after the search)
+    uint64_t pawnProbes;
+    uint64_t pawnHits;
+    uint64_t materialProbes;
+    uint64_t materialHits;
+    // static evaluations asked for, and how many came from the TT / the eval cache
+    uint64_t evalProbes;
+    uint64_t evalTTHits;
+    uint64_t evalCacheHits;
 
     void reset() {
         nodes = 0;
+        qnodes = 0;
         depthReached = 0;
+        pawnProbes = 0;
+        pawnHits = 0;
+        materialProbes = 0;
+        materialHits = 0;
+        evalProbes = 0;
+        evalTTHits = 0;
+        evalCacheHits = 0;
+    }
+
+    // Only the owning thread writes, so a relaxed load + store is enough (no lock prefix)
+    void addNode() {
+        nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     }
 };
 
@@ -41,12 +68,19 @@ struct Info {
     int maxDepth;
     // maximum number of nodes to search
     uint64_t maxNodes;
-    bool stopped;
-
+    // shared stop signal: set by the UCI thread ("stop", "quit"), when the time runs out,
+    // and by the main thread to end all helper threads
+    // Cleared by whoever starts the search, before it starts, so an early "stop" isn't lost
+    std::atomic<bool> stopped;
+    // "go ponder" until "ponderhit": the time limit doesn't apply yet
+    std::atomic<bool> ponder;
+    // "go infinite": no time limit, search until "stop"
+    bool infinite;
+
+    // Per-search limits only, the stop / ponder / infinite flags belong to the caller
     void reset() {
         maxDepth = 0;
         maxNodes = UINT64_MAX;
-        stopped = false;
     }
 };
 
@@ -89,34 +123,118 @@ struct Stack {
     bool ttPv;             // Is this part of PV from TT?
 };
 
+// piece values for MVV-LVA (move ordering and delta pruning)
+constexpr int pieceValues[7] = {
+    0,   // EMPTY
+    100, // PAWN
+    300, // KNIGHT
+    300, // BISHOP
+    500, // ROOK
+    900, // QUEEN
+    0    // KING
+};
+
+// Time checks: the main thread reads the clock about every TIME_CHECK_MS,
+// counted in nodes (at least / at most this many nodes between reads)
+constexpr int TIME_CHECK_MS = 1;
+constexpr int MIN_TIME_CHECK_NODES = 128;
+constexpr int MAX_TIME_CHECK_NODES = 65536;
+
+// History heuristic: [from][to] -> score
+// Tracks how often a move causes a beta cutoff
+constexpr int HISTORY_MAX = 10000;  // Cap to prevent overflow
+
+// A root move with its scores and PV. The root list is re-sorted after every
+// search of the root (best first), which orders the moves for the next one
+struct RootMove {
+    Move move;
+    int score = -INFINITY_SCORE;          // this iteration, -INFINITY_SCORE: not better than alpha
+    int previousScore = -INFINITY_SCORE;  // last iteration
+    uint64_t nodes = 0;                   // nodes this thread searched below the move this iteration
+    Move pv[MAX_PLY];                     // pv[0] is the move, ends at an empty move
+
+    explicit RootMove(const Move& m) : move(m) { pv[0] = m; }
+
+    // Sort order: better score first, ties by the previous iteration
+    bool operator<(const RootMove& other) const {
+        return score != other.score ? score > other.score : previousScore > other.previousScore;
+    }
+};
+
+// Per-thread search state (Lazy SMP)
+// Every search thread owns one of these, the only shared structure is TT::tt
+struct ThreadData {
+    int id;                          // 0 = main thread, others are helpers
+    Stats stats;                     // nodes searched by this thread
+    KillerMoves killers[MAX_PLY];    // killer moves per ply
+    int history[64][64];             // history heuristic [from][to]
+    uint64_t searchPath[MAX_PLY];    // hash keys along the current line (repetition detection)
+    Pawns::Table pawnTable;          // pawn structure cache, kept between searches
+    Material::Table materialTable;   // material / endgame cache, kept between searches
+    Evaluation::Cache evalCache;     // static evaluations by position, kept between searches
+    int rootDepth;                   // current iteration's root depth
+    std::vector<RootMove> rootMoves; // legal root moves, best first after each iteration
+    int timeCheckCounter;            // main thread: nodes left until the next clock read
+    int timeCheckInterval;           // main thread: nodes between clock reads
+
+    // Result of the last fully completed iteration
+    Move bestMove;
+    Move ponderMove;                 // expected reply (second PV move), may be empty
+    int bestScore;
+    int completedDepth;
+
+    // Reset everything before a new search
+    void clear();
+};
+
 // Main search entry point
-Move findBestMove(Board &board, int depth);
+// ponderMove (optional) receives the expected reply to the returned move, empty if unknown
+Move findBestMove(Board &board, int depth, Move* ponderMove = nullptr);
+
+// "ponderhit": the opponent played the move we ponder on, the running search
+// becomes a normal timed search whose clock starts now (TT, history and the
+// iterations done so far are kept)
+void ponderhit();
+
+// Number of search threads (1 = single threaded search)
+void setThreadCount(int count);
+int threadCount();
+
+// Empty the static evaluation cache of every thread (the evaluation function changed)
+void clearEvalCaches();
+
+// Number of best lines searched and reported ("MultiPV" option, 1 = best move only)
+void setMultiPV(int count);
+int multiPVCount();
 
 // Internal alpha-beta function
 template<NodeType NT>
-int alphaBeta(Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut = nullptr);
+int alphaBeta(ThreadData &td, Board &board, Stack* stackPtr, int depth, int alpha, int beta, bool cutNode, Move* bestMoveOut = nullptr);
 
 // Quiescence search - searches captures until position is quiet
-int quiescence(Board &board, Stack* stackPtr, int alpha, int beta);
+int quiescence(ThreadData &td, Board &board, Stack* stackPtr, int alpha, int beta);
 
 // Helper function
 int getMateScore(const Stack* stackPtr);
 void initReductions();
 
-// Move ordering function
-int scoreMove(const Move& move, const Board& board, const Stack* stackPtr);
-
-// History heuristic: [from][to] -> score
-// Tracks how often a move causes a beta cutoff
-constexpr int HISTORY_MAX = 10000;  // Cap to prevent overflow
-extern KillerMoves killers[MAX_PLY];
-extern int history[64][64];
 
 // Late Move Reduction
 constexpr int LMR_TABLE_SIZE = 64;
 extern int reductionTable[LMR_TABLE_SIZE][LMR_TABLE_SIZE];
 
-// Global statistics
+// Aspiration windows: first window is previous score +- ASPIRATION_DELTA, widened by
+// half its size after every fail, used from ASPIRATION_MIN_DEPTH on
+constexpr int ASPIRATION_DELTA = 25;
+constexpr int ASPIRATION_MIN_DEPTH = 4;
+
+// SEE pruning at shallow depth: a move is skipped when its exchange loses more than
+// SEE_CAPTURE_MARGIN * depth (captures, promotions) or SEE_QUIET_MARGIN * depth^2 (quiets)
+constexpr int SEE_PRUNING_DEPTH = 6;
+constexpr int SEE_CAPTURE_MARGIN = 100;
+constexpr int SEE_QUIET_MARGIN = 15;
+
+// Global statistics (nodes are summed over all threads at the end of a search)
 extern Stats stats;
 extern Info info;
 } // namespace Search
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "timeman.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace TimeMan {
+    // Moves we plan for in sudden death, and the most we plan for with movestogo
+    constexpr int SUDDEN_DEATH_MOVES = 40;
+    constexpr int MAX_MOVES_TO_GO = 50;
+
+    Allocation allocate(int timeLeft, int increment, int movesToGo, bool ponder) {
+        int mtg = movesToGo > 0 ? std::min(movesToGo, MAX_MOVES_TO_GO) : SUDDEN_DEATH_MOVES;
+
+        // Time we can use for the next mtg moves: the clock plus the increments
+        // still to come, minus the overhead of every move
+        int64_t total = int64_t(timeLeft) + int64_t(increment) * (mtg - 1) - int64_t(MOVE_OVERHEAD) * (2 + mtg);
+        total = std::max<int64_t>(total, 1);
+
+        int64_t optimum = total / mtg;
+        if (ponder) {
+            optimum += optimum / 4;
+        }
+
+        // Never more than 5x the optimum, and always keep some of the clock:
+        // the increment only arrives after the move
+        int64_t maximum = std::min<int64_t>(optimum * 5, timeLeft * 4 / 5 - MOVE_OVERHEAD);
+        maximum = std::max<int64_t>(maximum, 1);
+        optimum = std::min(optimum, maximum);
+
+        return { static_cast<int>(optimum), static_cast<int>(maximum) };
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+namespace TimeMan {
+    // Time lost between our "bestmove" and the GUI stopping our clock (ms)
+    constexpr int MOVE_OVERHEAD = 10;
+
+    // Time budget of one move, in milliseconds
+    // optimum: soft limit, scaled by the search (best move stability, score drops,
+    //          node effort) and checked between iterations
+    // maximum: hard limit, the search stops mid-iteration when it is reached
+    struct Allocation {
+        int optimum;
+        int maximum;
+    };
+
+    // Budget for a move from our clock: time left, increment and moves until the
+    // next time control (0 = sudden death). ponder: the GUI lets us ponder, so some
+    // of the moves are played from a ponderhit and we can spend a bit more
+    Allocation allocate(int timeLeft, int increment, int movesToGo, bool ponder);
+}
@@ -1,96 +1,392 @@
 #include "tt.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <ostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace TT {
-    // Global TT instance (128 MB by default)
-    TranspositionTable tt(128);
-    
-    TranspositionTable::TranspositionTable(size_t sizeMB) : currentGeneration(0) {
+    // Global TT instance, allocated at startup with resize(DEFAULT_SIZE_MB)
+    TranspositionTable tt;
+
+    // Allocate size bytes aligned to a 2 MB boundary so that the kernel can back
+    // the table with transparent huge pages (fewer TLB misses on random probes)
+    static void* alignedLargePagesAlloc(size_t size) {
+        constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+        size_t alignment = size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : alignof(Cluster);
+        // aligned_alloc requires size to be a multiple of the alignment
+        size = ((size + alignment - 1) / alignment) * alignment;
+        void* mem = std::aligned_alloc(alignment, size);
+        if (!mem) {
+            throw std::bad_alloc();
+        }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (alignment == HUGE_PAGE_SIZE) {
+            madvise(mem, size, MADV_HUGEPAGE);
+        }
+#endif
+        return mem;
+    }
+
+    uint64_t TTData::pack() const {
+        return  static_cast<uint64_t>(bestMove.encode())
+             | (static_cast<uint64_t>(static_cast<uint16_t>(value)) << 16)
+             | (static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 32)
+             | (static_cast<uint64_t>(genBound) << 40)
+             | (static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 48);
+    }
+
+    TTData TTData::unpack(uint64_t data) {
+        TTData d;
+        d.bestMove = Move::decode(static_cast<uint16_t>(data));
+        d.value = static_cast<int16_t>(static_cast<uint16_t>(data >> 16));
+        d.depth = static_cast<int8_t>(static_cast<uint8_t>(data >> 32));
+        d.genBound = static_cast<uint8_t>(data >> 40);
+        d.eval = static_cast<int16_t>(static_cast<uint16_t>(data >> 48));
+        return d;
+    }
+
+    TranspositionTable::TranspositionTable(size_t sizeMB)
+        : table(nullptr), clusterCount(0), currentGeneration(0), header(nullptr), mappedBytes(0) {
+        if (sizeMB > 0) {
+            resize(sizeMB);
+        }
+    }
+
+    void TranspositionTable::release() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (header) {
+            header->generation = currentGeneration;
+            munmap(header, mappedBytes);
+            header = nullptr;
+            mappedBytes = 0;
+            table = nullptr;
+        }
+#endif
+        std::free(table);
+        table = nullptr;
+        clusterCount = 0;
+    }
+
+    bool TranspositionTable::resize(size_t sizeMB, size_t numThreads) {
         // Calculate number of clusters (each cluster has CLUSTER_SIZE entries)
-        size_t sizeBytes = sizeMB * 1024 * 1024;
+        size_t sizeBytes = std::max<size_t>(sizeMB, 1) * 1024 * 1024;
         size_t numClusters = sizeBytes / sizeof(Cluster);
-        
-        // Round down to power of 2 for fast modulo with mask
-        size_t power = 1;
-        while (power * 2 <= numClusters) {
-            power *= 2;
-        }
-        numClusters = power;
-        mask = numClusters - 1;
-        
-        // Allocate table using vector of clusters
-        table.resize(numClusters);
-    }
-    
-    
-    TTEntry* TranspositionTable::probe(uint64_t key) {
+
+        // Allocate the new aligned cluster array before giving up the old one,
+        // so a failed allocation leaves the current table in place
+        Cluster* newTable;
+        try {
+            newTable = static_cast<Cluster*>(alignedLargePagesAlloc(numClusters * sizeof(Cluster)));
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+
+        release();
+        table = newTable;
+        clusterCount = numClusters;
+        clear(numThreads);
+        return true;
+    }
+
+    TranspositionTable::~TranspositionTable() {
+        release();
+    }
+
+    bool TranspositionTable::mapFile(const std::string& path, size_t sizeMB) {
+        release();
+
+#if defined(__unix__) || defined(__APPLE__)
+        size_t numClusters = std::max<size_t>(sizeMB, 1) * 1024 * 1024 / sizeof(Cluster);
+        size_t bytes = sizeof(FileHeader) + numClusters * sizeof(Cluster);
+
+        int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            return false;
+        }
+        void* mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);  // the mapping keeps the file alive
+        if (mem == MAP_FAILED) {
+            return false;
+        }
+
+        header = static_cast<FileHeader*>(mem);
+        mappedBytes = bytes;
+        table = reinterpret_cast<Cluster*>(static_cast<char*>(mem) + sizeof(FileHeader));
+        clusterCount = numClusters;
+
+        // Reuse the previous contents only if they were written by a compatible engine
+        // with the same keys and size, otherwise start from an empty table
+        uint64_t keySignature = Zobrist::sideKey ^ Zobrist::castlingKeys[0];
+        bool compatible = header->magic == FILE_MAGIC
+                       && header->version == FILE_VERSION
+                       && header->clusterBytes == sizeof(Cluster)
+                       && header->keySignature == keySignature
+                       && header->clusterCount == numClusters;
+
+        if (compatible) {
+            currentGeneration = header->generation;
+        } else {
+            clear();
+            header->magic = FILE_MAGIC;
+            header->version = FILE_VERSION;
+            header->clusterBytes = sizeof(Cluster);
+            header->keySignature = keySignature;
+            header->clusterCount = numClusters;
+            header->generation = currentGeneration;
+        }
+        return true;
+#else
+        (void)path;
+        (void)sizeMB;
+        return false;
+#endif
+    }
+
+
+    bool TranspositionTable::probe(uint64_t key, TTData& out) const {
         size_t clusterIndex = getIndex(key);
-        Cluster* cluster = &table[clusterIndex];
-        
-        // Check all 3 entries in the cluster
+        const Cluster* cluster = &table[clusterIndex];
+
+        // Check all entries in the cluster (one cache line)
         for (int i = 0; i < CLUSTER_SIZE; i++) {
-            if (cluster->entries[i].key == key) {
-                return &cluster->entries[i];
+            if (cluster->read(i, key, out)) {
+                return true;
             }
         }
-        
-        return nullptr;
+
+        return false;
     }
-    
-    void TranspositionTable::store(uint64_t key, int value, int depth, NodeType type, const Move& bestMove) {
+
+    void TranspositionTable::store(uint64_t key, int value, int depth, NodeType type, const Move& bestMove, int eval) {
         size_t clusterIndex = getIndex(key);
         Cluster* cluster = &table[clusterIndex];
-        
+
+        TTData newData;
+        newData.bestMove = bestMove;
+        newData.value = static_cast<int16_t>(value);
+        newData.depth = static_cast<int8_t>(depth);
+        newData.genBound = static_cast<uint8_t>(currentGeneration | type);
+        newData.eval = static_cast<int16_t>(eval);
+
         // 1. First, check if the position already exists in the cluster
         for (int i = 0; i < CLUSTER_SIZE; i++) {
-            if (cluster->entries[i].key == key) {
+            TTData old;
+            if (cluster->read(i, key, old)) {
                 // Preserve tt move if we don't have a new one
                 if (bestMove.from == 0 && bestMove.to == 0) {
-                } else {
-                    cluster->entries[i].bestMove = bestMove;
+                    newData.bestMove = old.bestMove;
+                }
+                // Same for the static eval
+                if (eval == EVAL_NONE) {
+                    newData.eval = old.eval;
                 }
-                
+
                 // Always update if same position (can improve with deeper search)
-                if (type == EXACT || depth > cluster->entries[i].depth - 4) {
-                    cluster->entries[i].value = static_cast<int16_t>(value);
-                    cluster->entries[i].depth = static_cast<int8_t>(depth);
-                    cluster->entries[i].generation = currentGeneration;
-                    cluster->entries[i].type = type;
+                if (!(type == EXACT || depth > old.depth - 4)) {
+                    newData.value = old.value;
+                    newData.depth = old.depth;
+                    newData.genBound = old.genBound;
                 }
+                cluster->write(i, key, newData);
                 return;
             }
         }
-        
-        // 2. Position not in cluster 
+
+        // 2. Position not in cluster
         //replace entry with lowest score
         // Score = depth - 8 * age
-        TTEntry* replace = &cluster->entries[0];
-        int minScore = replace->depth - 8 * replace->relative_age(currentGeneration);
-        
+        // (empty or torn entries decode to garbage, which is fine: they are just replaced like any other)
+        int replace = 0;
+        TTData first = TTData::unpack(cluster->data[0].load(std::memory_order_relaxed));
+        int minScore = first.depth - 8 * relative_age(first.genBound, currentGeneration);
+
         for (int i = 1; i < CLUSTER_SIZE; i++) {
-            int score = cluster->entries[i].depth - 8 * cluster->entries[i].relative_age(currentGeneration);
+            TTData d = TTData::unpack(cluster->data[i].load(std::memory_order_relaxed));
+            int score = d.depth - 8 * relative_age(d.genBound, currentGeneration);
             if (score < minScore) {
                 minScore = score;
-                replace = &cluster->entries[i];
+                replace = i;
             }
         }
-        
+
         // Replace the entry
-        replace->key = key;
-        replace->value = static_cast<int16_t>(value);
-        replace->depth = static_cast<int8_t>(depth);
-        replace->generation = currentGeneration;
-        replace->type = type;
-        replace->bestMove = bestMove;
-    }
-    
-    void TranspositionTable::clear() {
-        std::fill(table.begin(), table.end(), Cluster());
+        cluster->write(replace, key, newData);
+    }
+
+    void TranspositionTable::clear(size_t numThreads) {
+        // All-zero words are empty slots (data == 0 is rejected on probe)
+        // Each thread zeroes its own slice, so multi-GB tables don't take seconds
+        numThreads = std::max<size_t>(numThreads, 1);
+        size_t stride = clusterCount / numThreads;
+        std::vector<std::thread> workers;
+
+        for (size_t idx = 0; idx < numThreads; idx++) {
+            size_t start = stride * idx;
+            size_t len = (idx + 1 == numThreads) ? clusterCount - start : stride;
+            auto zero = [this, start, len]() {
+                std::memset(static_cast<void*>(table + start), 0, len * sizeof(Cluster));
+            };
+            if (idx + 1 == numThreads) {
+                zero();  // last slice on the calling thread
+            } else {
+                workers.emplace_back(zero);
+            }
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
         currentGeneration = 0;
+        if (header) {
+            header->generation = currentGeneration;
+        }
     }
-    
+
     void TranspositionTable::new_search() {
-        // Increment generation for new search
-        currentGeneration++;
+        // Increment generation for new search (upper 6 bits, wraps around)
+        currentGeneration += GENERATION_DELTA;
+        // Persist it right away so the next run continues from here
+        if (header) {
+            header->generation = currentGeneration;
+        }
     }
-}
 
+    int TranspositionTable::hashfull(int maxAge) const {
+        size_t samples = std::min<size_t>(1000, clusterCount);
+        if (samples == 0) return 0;
+
+        int count = 0;
+        for (size_t i = 0; i < samples; i++) {
+            for (int j = 0; j < CLUSTER_SIZE; j++) {
+                uint64_t d = table[i].data[j].load(std::memory_order_relaxed);
+                if (d != 0 && relative_age(TTData::unpack(d).genBound, currentGeneration) <= maxAge) {
+                    count++;
+                }
+            }
+        }
+        return static_cast<int>(count * 1000 / (samples * CLUSTER_SIZE));
+    }
+
+    void TranspositionTable::printStats(std::ostream& os) const {
+        constexpr int MAX_DEPTH = 128;
+        constexpr int MAX_AGE = 64;
+        uint64_t used = 0;
+        uint64_t depthCount[MAX_DEPTH] = {};
+        uint64_t typeCount[4] = {};
+        uint64_t ageCount[MAX_AGE] = {};
+
+        for (size_t i = 0; i < clusterCount; i++) {
+            for (int j = 0; j < CLUSTER_SIZE; j++) {
+                uint64_t d = table[i].data[j].load(std::memory_order_relaxed);
+                if (d == 0) continue;
+                TTData entry = TTData::unpack(d);
+                used++;
+                depthCount[std::clamp<int>(entry.depth, 0, MAX_DEPTH - 1)]++;
+                typeCount[entry.type()]++;
+                ageCount[relative_age(entry.genBound, currentGeneration)]++;
+            }
+        }
+
+        uint64_t total = clusterCount * CLUSTER_SIZE;
+        os << "TT: " << sizeMB() << " MB, " << clusterCount << " clusters, " << total << " entries\n";
+        os << "Used entries: " << used << " (" << (total ? used * 1000 / total : 0) << " permille)"
+           << ", hashfull: " << hashfull() << "\n";
+        if (used == 0) return;
+
+        // Print one line per non-empty bucket with its share of the used entries
+        auto printRow = [&](const std::string& label, uint64_t n) {
+            if (n == 0) return;
+            os << "  " << label << ": " << n << " (" << (n * 1000 / used) << " permille)\n";
+        };
+
+        os << "Depth:\n";
+        for (int depth = 0; depth < MAX_DEPTH; depth++) {
+            printRow(std::to_string(depth), depthCount[depth]);
+        }
+        os << "Node type:\n";
+        printRow("EXACT", typeCount[EXACT]);
+        printRow("LOWERBOUND", typeCount[LOWERBOUND]);
+        printRow("UPPERBOUND", typeCount[UPPERBOUND]);
+        os << "Age (searches ago):\n";
+        for (int age = 0; age < MAX_AGE; age++) {
+            printRow(std::to_string(age), ageCount[age]);
+        }
+    }
+
+    // Every key stores data that is a pure function of the key, so any entry that
+    // a probe returns for key K must decode to exactly expected(K)
+    static TTData expectedData(uint64_t key) {
+        TTData d;
+        d.bestMove = Move((key >> 8) & 0x3F, (key >> 14) & 0x3F, static_cast<PieceType>((key >> 20) % 6));
+        d.value = static_cast<int16_t>(key >> 24);
+        d.depth = static_cast<int8_t>((key >> 40) & 0x3F);
+        d.genBound = static_cast<uint8_t>((key >> 48) & 0x3);
+        d.eval = static_cast<int16_t>(key >> 50);
+        return d;
+    }
+
+    bool stressTest(int numThreads, int iterations) {
+        // Small table so that threads constantly collide on the same clusters
+        TranspositionTable table(1);
+        // Few distinct keys so the same positions get written and read over and over
+        constexpr int NUM_KEYS = 1 << 16;
+        std::vector<uint64_t> keys(NUM_KEYS);
+        std::mt19937_64 rng(0xC0FFEEULL);
+        for (uint64_t& key : keys) {
+            key = rng();
+        }
+
+        std::atomic<uint64_t> corrupt(0);
+        std::atomic<uint64_t> hits(0);
+        std::vector<std::thread> workers;
+
+        for (int t = 0; t < numThreads; t++) {
+            workers.emplace_back([&, t]() {
+                std::mt19937_64 threadRng(t + 1);
+                uint64_t localHits = 0, localCorrupt = 0;
+                for (int i = 0; i < iterations; i++) {
+                    uint64_t key = keys[threadRng() % NUM_KEYS];
+                    if (threadRng() & 1) {
+                        TTData d = expectedData(key);
+                        table.store(key, d.value, d.depth, d.type(), d.bestMove, d.eval);
+                    } else {
+                        TTData d;
+                        if (table.probe(key, d)) {
+                            localHits++;
+                            TTData e = expectedData(key);
+                            if (d.pack() != e.pack()) {
+                                localCorrupt++;
+                            }
+                        }
+                    }
+                }
+                hits += localHits;
+                corrupt += localCorrupt;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        std::cout << "TT stress test: " << numThreads << " threads, "
+                  << hits.load() << " hits, " << corrupt.load() << " corrupt entries\n";
+        return corrupt.load() == 0;
+    }
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
-#include <vector>
+#include <iosfwd>
+#include <string>
 #include "move.h"
 
 namespace TT {
@@ -11,64 +13,174 @@ namespace TT {
         LOWERBOUND = 1, // All node - beta cutoff (score >= beta)
         UPPERBOUND = 2  // Cut node - alpha didn't improve (score <= alpha)
     };
-    
-    // Transposition table entry
-    struct TTEntry {
-        uint64_t key;         // Full 64-bit Zobrist key
-        int16_t value;        // Evaluation score
-        int8_t depth;         // Search depth  
-        uint8_t generation;   // Age/generation for replacement strategy
-        NodeType type;        // Node type
+
+    // Generation is kept in the upper 6 bits of the genBound byte, the node type in the lower 2
+    constexpr uint8_t GENERATION_DELTA = 4;
+    constexpr int GENERATION_CYCLE = 255 + GENERATION_DELTA;
+    constexpr uint8_t GENERATION_MASK = 0xFC;
+
+    // Stored static eval of an entry that doesn't have one
+    constexpr int16_t EVAL_NONE = INT16_MIN;
+
+    // Decoded copy of a table entry, this is what the search gets back from a probe
+    struct TTData {
         Move bestMove;        // Best move found
-        
-        TTEntry() : key(0), value(0), depth(-1), generation(0), type(EXACT), bestMove() {}
-        
-        // Calculate age relative to current generation
-        uint8_t relative_age(uint8_t currentGen) const {
-            // Handles wrap-around correctly
-            return (255 + currentGen - generation) & 0xFF;
+        int16_t value;        // Evaluation score
+        int8_t depth;         // Search depth
+        uint8_t genBound;     // Generation (upper 6 bits) + node type (lower 2 bits)
+        int16_t eval;         // Static evaluation of the position (EVAL_NONE if not computed)
+
+        NodeType type() const { return static_cast<NodeType>(genBound & 0x3); }
+        uint8_t generation() const { return genBound & GENERATION_MASK; }
+
+        // Pack / unpack into the 64-bit data word
+        // [move: 16][value: 16][depth: 8][genBound: 8][eval: 16]
+        uint64_t pack() const;
+        static TTData unpack(uint64_t data);
+    };
+
+    // Calculate age (in searches) of an entry relative to current generation
+    inline uint8_t relative_age(uint8_t genBound, uint8_t currentGen) {
+        // Handles wrap-around correctly
+        return ((GENERATION_CYCLE + currentGen - genBound) & GENERATION_MASK) / GENERATION_DELTA;
+    }
+
+    // Cluster of 5 entries packed into exactly one 64-byte cache line, so a probe
+    // or store touches a single line.
+    // Each entry is a 64-bit packed data word plus a 32-bit key fragment (lower 32
+    // bits of the Zobrist key, the upper bits already select the cluster).
+    // Lockless (Hyatt) scheme: the fragment is stored XORed with both halves of
+    // the data word. If two threads write the same slot at the same time the words
+    // no longer match and the probe rejects the entry instead of returning a torn one.
+    static constexpr int CLUSTER_SIZE = 5;
+
+    struct alignas(64) Cluster {
+        std::atomic<uint64_t> data[CLUSTER_SIZE];        // Packed TTData (0 = empty slot)
+        std::atomic<uint32_t> keyXorData[CLUSTER_SIZE];  // Key fragment ^ low ^ high data halves
+        uint32_t padding;
+
+        static uint32_t keyFragment(uint64_t key) { return static_cast<uint32_t>(key); }
+        static uint32_t fold(uint64_t d) { return static_cast<uint32_t>(d) ^ static_cast<uint32_t>(d >> 32); }
+
+        // Read both words of entry i, returns false when the entry doesn't belong
+        // to key (empty, different position or a torn write)
+        bool read(int i, uint64_t key, TTData& out) const {
+            uint64_t d = data[i].load(std::memory_order_relaxed);
+            uint32_t k = keyXorData[i].load(std::memory_order_relaxed);
+            if (d == 0 || (k ^ fold(d)) != keyFragment(key)) return false;
+            out = TTData::unpack(d);
+            return true;
+        }
+
+        void write(int i, uint64_t key, const TTData& in) {
+            uint64_t d = in.pack();
+            keyXorData[i].store(keyFragment(key) ^ fold(d), std::memory_order_relaxed);
+            data[i].store(d, std::memory_order_relaxed);
         }
     };
-    
-    // Cluster of 3 entries (best relation between efficiency and accuracy)
-    static constexpr int CLUSTER_SIZE = 3;
-    
-    struct Cluster {
-        TTEntry entries[CLUSTER_SIZE];
+
+    static_assert(sizeof(Cluster) == 64, "TT cluster must fill exactly one cache line");
+
+    // Default size in MB, can be changed at runtime with resize() (UCI "Hash" option)
+    constexpr size_t DEFAULT_SIZE_MB = 128;
+
+    // Header at the start of a memory-mapped table file (see mapFile)
+    // Padded to a page so the clusters that follow stay cache-line aligned
+    struct alignas(4096) FileHeader {
+        uint64_t magic;          // FILE_MAGIC
+        uint32_t version;        // FILE_VERSION, bump when the entry layout changes
+        uint32_t clusterBytes;   // sizeof(Cluster)
+        uint64_t keySignature;   // identifies the Zobrist keys the entries were hashed with
+        uint64_t clusterCount;
+        uint8_t generation;      // generation of the last search, carried over to the next run
     };
-    
+
+    constexpr uint64_t FILE_MAGIC = 0x4D434D5454424C31ULL;  // "MCMTTBL1"
+    constexpr uint32_t FILE_VERSION = 2;
+
     // Transposition table class
+    // Safe to probe/store from any number of search threads without locks
     class TranspositionTable {
     private:
-        std::vector<Cluster> table;
-        size_t mask;
+        Cluster* table;             // Cache-line (huge page when possible) aligned cluster array
+        size_t clusterCount;
         uint8_t currentGeneration;  // Incremented each search
-        
+
+        // Memory-mapped file backing (nullptr when the table is in anonymous memory)
+        FileHeader* header;
+        size_t mappedBytes;
+
+        // Release the current backing memory (heap or mapping)
+        void release();
+
     public:
-        TranspositionTable(size_t sizeMB = 128);
-        
-        // Probe the table
-        TTEntry* probe(uint64_t key);
-        
+        // sizeMB = 0 creates an empty table, call resize() before searching
+        TranspositionTable(size_t sizeMB = 0);
+        ~TranspositionTable();
+        TranspositionTable(const TranspositionTable&) = delete;
+        TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+        // Probe the table, on a hit a validated copy of the entry is written to out
+        bool probe(uint64_t key, TTData& out) const;
+
+        // Prefetch the cluster of key into the CPU cache
+        // Called right after makeMove so the DRAM fetch overlaps with the work done
+        // before the child node probes the table. Building with -DNO_PREFETCH turns it
+        // off to measure the difference with bench
+        inline void prefetch([[maybe_unused]] uint64_t key) const {
+#if !defined(NO_PREFETCH) && (defined(__GNUC__) || defined(__clang__))
+            __builtin_prefetch(&table[getIndex(key)]);
+#endif
+        }
+
         // Store an entry
-        void store(uint64_t key, int value, int depth, NodeType type, const Move& bestMove);
-        
-        // Clear the table
-        void clear();
-        
+        // eval is the static evaluation if the search computed one, an entry that
+        // is overwritten for the same position keeps its old eval otherwise
+        void store(uint64_t key, int value, int depth, NodeType type, const Move& bestMove, int eval = EVAL_NONE);
+
+        // Reallocate the table with sizeMB megabytes (contents are cleared)
+        // Returns false, keeping the current table and its contents, if the memory
+        // can't be allocated
+        bool resize(size_t sizeMB, size_t numThreads = 1);
+
+        // Back the table with a memory-mapped file of sizeMB megabytes so that its
+        // contents (and the generation counter) survive between runs of the engine.
+        // A file written with another size, entry layout or set of Zobrist keys is
+        // reset. Returns false if the file could not be mapped (table is left empty)
+        bool mapFile(const std::string& path, size_t sizeMB);
+
+        // Current size in MB
+        size_t sizeMB() const { return clusterCount * sizeof(Cluster) / (1024 * 1024); }
+
+        // Clear the table, zeroing it with numThreads threads in parallel
+        void clear(size_t numThreads = 1);
+
         // Start new search (increment generation)
         void new_search();
-        
+
         // Get current generation
         uint8_t generation() const { return currentGeneration; }
-        
+
+        // Approximate occupancy in permille (UCI "hashfull"), sampled over the
+        // first 1000 clusters. Only counts entries written in the last maxAge searches
+        int hashfull(int maxAge = 0) const;
+
+        // Debug: scan the whole table and print histograms of depth, node type and age
+        void printStats(std::ostream& os) const;
+
         // Get cluster index from key
+        // Fixed-point multiply maps the upper key bits onto [0, clusterCount), so the
+        // table doesn't need a power of 2 size
         inline size_t getIndex(uint64_t key) const {
-            return key & mask;
+            return static_cast<size_t>((static_cast<unsigned __int128>(key) * clusterCount) >> 64);
         }
     };
-    
+
     // Global transposition table
     extern TranspositionTable tt;
-}
 
+    // Hammers a small table from numThreads threads with concurrent stores and probes
+    // and checks that no probe ever returns a corrupt (torn) entry
+    // Returns true if all probes were consistent
+    bool stressTest(int numThreads, int iterations);
+}
@@ -7,6 +7,7 @@ namespace Zobrist {
     uint64_t sideKey;
     uint64_t castlingKeys[16];
     uint64_t enPassantKeys[8];
+    uint64_t noPawnsKey;
     
     // Use a fixed seed for reproducibility (which can be changed)
     constexpr uint64_t SEED = 0x123456789ABCDEFULL;
@@ -37,6 +38,9 @@ namespace Zobrist {
         for (int file = 0; file < 8; ++file) {
             enPassantKeys[file] = dist(rng);
         }
+        
+        // Drawn last so the other keys (and saved TT files) stay the same
+        noPawnsKey = dist(rng);
     }
     
     uint64_t computeHash(const Board& board) {
@@ -75,5 +79,34 @@ namespace Zobrist {
         
         return hash;
     }
+    
+    uint64_t computePawnHash(const Board& board) {
+        uint64_t hash = noPawnsKey;
+        
+        for (int color = 0; color < 2; ++color) {
+            uint64_t pawns = board.bitboards[color][PAWN];
+            while (pawns) {
+                int square = Board::popLsb(pawns);
+                hash ^= pieceKeys[color][PAWN][square];
+            }
+        }
+        
+        return hash;
+    }
+    
+    uint64_t computeMaterialHash(const Board& board) {
+        uint64_t hash = 0ULL;
+        
+        // Kings are included so that the bare kings key isn't 0 (an empty material hash slot)
+        for (int color = 0; color < 2; ++color) {
+            for (int pieceType = PAWN; pieceType <= KING; ++pieceType) {
+                int count = Board::popcount(board.bitboards[color][pieceType]);
+                for (int n = 0; n < count; ++n) {
+                    hash ^= pieceKeys[color][pieceType][n];
+                }
+            }
+        }
+        
+        return hash;
+    }
 }
-
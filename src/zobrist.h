@@ -16,12 +16,23 @@ namespace Zobrist {
     // Zobrist keys for en passant file (0-7, file a-h)
     extern uint64_t enPassantKeys[8];
     
+    // Base of the pawn key, so a position without pawns doesn't hash to 0
+    // (an empty pawn hash slot)
+    extern uint64_t noPawnsKey;
+    
     // Initialize all Zobrist keys with random numbers
     void init();
     
     // Compute hash from scratch (for debugging/initialization)
     uint64_t computeHash(const Board& board);
     
+    // Compute the pawn structure key from scratch (pawn piece keys only)
+    uint64_t computePawnHash(const Board& board);
+    
+    // Compute the material key from scratch
+    // Only the piece counts matter: the n-th piece of a type adds pieceKeys[color][type][n - 1]
+    uint64_t computeMaterialHash(const Board& board);
+    
     // Helper to get castling rights index
     inline int getCastlingIndex(bool wk, bool wq, bool bk, bool bq) {
         return (wk ? 8 : 0) | (wq ? 4 : 0) | (bk ? 2 : 0) | (bq ? 1 : 0);
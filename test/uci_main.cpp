@@ -6,20 +6,28 @@
  * The original main.cpp interface remains unchanged for teacher evaluation.
  */
 
+#include "../src/bench.h"
 #include "../src/board.h"
 #include "../src/eval/evaluate.h"
+#include "../src/eval/nnue.h"
 #include "../src/eval/psqt.h"
 #include "../src/gen.hpp"
 #include "../src/move.h"
 #include "../src/search.h"
 #include "../src/zobrist.h"
+#include "../src/timeman.h"
 #include "../src/tt.h"
 #include "../src/magic.h"
+#include "../src/perft.h"
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
+#include <charconv>
 #include <chrono>
+#include <iomanip>
+#include <limits>
+#include <thread>
 
 // ==================== TIME CONTROL CONFIGURATION ====================
 // Switch between QUICK_MODE and SLOW_MODE by changing the active constant
@@ -40,33 +48,40 @@ const int MAX_TIME_PER_MOVE = USE_QUICK_MODE ? QUICK_MODE_MAX_TIME : SLOW_MODE_M
 const int DEFAULT_TIME_PER_MOVE = USE_QUICK_MODE ? QUICK_MODE_DEFAULT_TIME : SLOW_MODE_DEFAULT_TIME;
 // ====================================================================
 
-// External time limit from search.cpp
+// External time limits from search.cpp
 extern int time_limit_ms;
+extern int optimum_time_ms;
+
+// The search runs on its own thread so the loop keeps reading commands while it
+// thinks: "stop", "ponderhit" and "isready" are answered during the search
+static std::thread searchThread;
+
+// "Ponder" option: the GUI lets us think on the opponent's time ("go ponder")
+static bool ponderEnabled = false;
+
+// Block until the running search (if any) has printed its bestmove
+static void waitForSearch() {
+    if (searchThread.joinable()) {
+        searchThread.join();
+    }
+}
+
+// Ask the running search to stop and wait for its bestmove
+static void stopSearch() {
+    Search::info.stopped = true;
+    waitForSearch();
+}
 
 // Find a move in the legal moves list that matches the UCI string
 Move findMoveFromString(Board &board, const std::string &moveStr) {
     MoveGenerator gen(board, board.sideToMove);
-    Move pseudoLegal[220];
-    size_t pseudoLegalCount = gen.generatePseudoLegalMoves(pseudoLegal);
     Move legalMoves[220];
-    size_t legalCount = gen.filterLegalMoves(pseudoLegal, pseudoLegalCount, legalMoves);
+    size_t legalCount = gen.generateLegalMoves(legalMoves);
     
     for (size_t i = 0; i < legalCount; i++) {
         const Move &m = legalMoves[i];
-        std::string mStr = m.toString();
-        // Handle promotion suffix (e.g., "e7e8q")
-        if (m.promotion != PieceType::EMPTY) {
-            char promoChar = ' ';
-            switch (m.promotion) {
-                case PieceType::QUEEN:  promoChar = 'q'; break;
-                case PieceType::ROOK:   promoChar = 'r'; break;
-                case PieceType::BISHOP: promoChar = 'b'; break;
-                case PieceType::KNIGHT: promoChar = 'n'; break;
-                default: break;
-            }
-            mStr += promoChar;
-        }
-        if (mStr == moveStr) {
+        // UCI string includes the promotion suffix (e.g., "e7e8q")
+        if (m.toUci() == moveStr) {
             return m;
         }
     }
@@ -85,14 +100,16 @@ void handlePosition(Board &board, std::istringstream &is) {
         board.initStartPosition(); // Must initialize to starting position!
         is >> token;     // Consume "moves" if present
     } else if (token == "fen") {
-        // FEN support not implemented - fallback to startpos
-        // Skip FEN tokens until "moves" or end of line
+        // Collect the FEN fields until "moves" or end of line
+        std::string fen;
         while (is >> token && token != "moves") {
-            // Skip FEN parts
+            fen += (fen.empty() ? "" : " ") + token;
         }
         board = Board();
-        board.initStartPosition(); // Must initialize to starting position!
-        // Note: If FEN support is needed, implement board.setFromFEN()
+        if (!board.setFromFEN(fen)) {
+            std::cout << "info string invalid FEN, using the start position" << std::endl;
+            board.initStartPosition();
+        }
     }
 
     // Apply moves if present
@@ -109,13 +126,16 @@ void handleGo(Board &board, std::istringstream &is) {
     std::string token;
     int depth = 64;      // Default max depth
     int wtime = 0, btime = 0, winc = 0, binc = 0;
-    int movestogo = 30;  // Default moves to go
+    int movestogo = 0;   // 0 = sudden death
     int movetime = 0;
     bool infinite = false;
+    bool ponder = false;
+    bool depthGiven = false;
 
     while (is >> token) {
         if (token == "depth") {
             is >> depth;
+            depthGiven = true;
         } else if (token == "wtime") {
             is >> wtime;
         } else if (token == "btime") {
@@ -130,105 +150,295 @@ void handleGo(Board &board, std::istringstream &is) {
             is >> movetime;
         } else if (token == "infinite") {
             infinite = true;
+        } else if (token == "ponder") {
+            ponder = true;
         }
     }
 
-    // Time management: set time_limit_ms and let iterative deepening work
-    int searchDepth = depth;
-    
-    // Minimum time to prevent issues with very low time controls
-    constexpr int MIN_TIME_MS = 50;
+    // Time management: the hard limit (time_limit_ms) stops the search anywhere,
+    // the soft limit (optimum_time_ms) is checked between iterations and scaled
+    // by the search. The depth limit is "go depth N" or 64
+    int searchDepth = std::clamp(depth, 1, 64);
+    optimum_time_ms = 0;
     
     if (movetime > 0) {
         // Fixed time per move - use it directly, capped at max
-        time_limit_ms = std::max(MIN_TIME_MS, std::min(movetime - 50, MAX_TIME_PER_MOVE));
-        searchDepth = 64;  // Let time control limit the search
+        time_limit_ms = std::max(1, std::min(movetime - TimeMan::MOVE_OVERHEAD, MAX_TIME_PER_MOVE));
     } else if (wtime > 0 || btime > 0) {
         // Time control - allocate time based on remaining time
         int ourTime = (board.sideToMove == Color::WHITE) ? wtime : btime;
         int ourInc = (board.sideToMove == Color::WHITE) ? winc : binc;
         
-        // Simple allocation: use ~1/30th of remaining time + increment
-        int allocatedTime = ourTime / movestogo + ourInc;
-        
-        // Set time limit with small buffer, capped at max, with minimum floor
-        time_limit_ms = std::max(MIN_TIME_MS, std::min(allocatedTime - 20, MAX_TIME_PER_MOVE));
-        searchDepth = 64;  // Let time control limit the search
-    } else if (infinite) {
-        time_limit_ms = MAX_TIME_PER_MOVE;  // Use max time from active mode
-        searchDepth = 64;
+        TimeMan::Allocation alloc = TimeMan::allocate(ourTime, ourInc, movestogo, ponderEnabled);
+        time_limit_ms = std::min(alloc.maximum, MAX_TIME_PER_MOVE);
+        optimum_time_ms = std::min(alloc.optimum, time_limit_ms);
+    } else if (infinite || depthGiven) {
+        // "go infinite" searches until "stop", "go depth N" until the depth is done
+        time_limit_ms = std::numeric_limits<int>::max();
     } else {
         // No time info - use default time from active mode
         time_limit_ms = DEFAULT_TIME_PER_MOVE;
-        searchDepth = 64;
     }
 
+    // Flags are set before the thread starts, a "stop" read right after "go" is kept
+    Search::info.stopped = false;
+    Search::info.ponder = ponder;
+    Search::info.infinite = infinite;
+
     // Search for best move using iterative deepening with time control
-    Move bestMove = Search::findBestMove(board, searchDepth);
-    
-    // Check if we got a valid move (from == 0 && to == 0 means no legal moves)
-    if (bestMove.from == 0 && bestMove.to == 0) {
+    // The loop doesn't touch the board until the search is done (waitForSearch)
+    searchThread = std::thread([&board, searchDepth] {
+        Move ponderMove;
+        Move bestMove = Search::findBestMove(board, searchDepth, &ponderMove);
+
+        // Check if we got a valid move (from == 0 && to == 0 means no legal moves)
         // No legal moves - this is checkmate or stalemate
         // Output "bestmove 0000" which is the UCI null move notation
-        std::cout << "bestmove 0000" << std::endl;
-        return;
+        bool noMove = (bestMove.from == 0 && bestMove.to == 0);
+        std::string reply = "bestmove " + (noMove ? std::string("0000") : bestMove.toUci());
+        // Expected reply, the GUI sends it back with "go ponder"
+        if (!noMove && ponderMove.from != ponderMove.to) {
+            reply += " ponder " + ponderMove.toUci();
+        }
+        std::cout << (reply + "\n") << std::flush;
+    });
+}
+
+// Limits of the spin options, advertised by "uci" and applied by "setoption"
+constexpr int MAX_THREADS = 512;
+constexpr long long MAX_HASH_MB = 33554432;
+constexpr int MAX_MULTI_PV = 256;
+
+// Parse the value of a spin option, clamped to [min, max]
+// A missing or non-numeric value returns false and is reported, the option keeps its value
+static bool parseSpin(const std::string &name, const std::string &value, long long min, long long max, long long &out) {
+    long long parsed = 0;
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    if (value.empty() || ec != std::errc() || end != value.data() + value.size()) {
+        // Out of range numbers are clamped like any other value
+        if (ec == std::errc::result_out_of_range && end == value.data() + value.size()) {
+            out = value[0] == '-' ? min : max;
+            return true;
+        }
+        std::cout << "info string invalid value '" << value << "' for option " << name << std::endl;
+        return false;
     }
-    
-    // Format output
-    std::string moveStr = bestMove.toString();
-    if (bestMove.promotion != PieceType::EMPTY) {
-        char promoChar = ' ';
-        switch (bestMove.promotion) {
-            case PieceType::QUEEN:  promoChar = 'q'; break;
-            case PieceType::ROOK:   promoChar = 'r'; break;
-            case PieceType::BISHOP: promoChar = 'b'; break;
-            case PieceType::KNIGHT: promoChar = 'n'; break;
-            default: break;
+    out = std::clamp(parsed, min, max);
+    return true;
+}
+
+// Arguments of "bench [depth] [hash] [threads]" (UCI command and command line)
+// Missing arguments keep the Bench defaults, an invalid one is reported and returns false
+static bool parseBenchArgs(const std::vector<std::string> &args, int &depth, size_t &hashMB, int &numThreads) {
+    depth = Bench::DEFAULT_DEPTH;
+    hashMB = Bench::DEFAULT_HASH_MB;
+    numThreads = Bench::DEFAULT_THREADS;
+    long long n = 0;
+    if (args.size() > 0) {
+        if (!parseSpin("depth", args[0], 1, 64, n)) return false;
+        depth = static_cast<int>(n);
+    }
+    if (args.size() > 1) {
+        if (!parseSpin("hash", args[1], 1, MAX_HASH_MB, n)) return false;
+        hashMB = static_cast<size_t>(n);
+    }
+    if (args.size() > 2) {
+        if (!parseSpin("threads", args[2], 1, MAX_THREADS, n)) return false;
+        numThreads = static_cast<int>(n);
+    }
+    return true;
+}
+
+// "ttstress [threads]" (UCI command and command line): concurrent stores and probes on a
+// small TT, checked for torn entries. Returns false on a torn entry or an invalid argument
+constexpr int TT_STRESS_THREADS = 8;
+constexpr int TT_STRESS_ITERATIONS = 2000000;
+
+static bool runTTStress(const std::vector<std::string> &args) {
+    long long numThreads = TT_STRESS_THREADS;
+    if (!args.empty() && !parseSpin("threads", args[0], 1, MAX_THREADS, numThreads)) {
+        return false;
+    }
+    bool ok = TT::stressTest(static_cast<int>(numThreads), TT_STRESS_ITERATIONS);
+    std::cout << "TT stress test " << (ok ? "passed" : "FAILED") << std::endl;
+    return ok;
+}
+
+// Handle "setoption name <id> [value <x>]" command
+void handleSetOption(Board &board, std::istringstream &is) {
+    std::string token, name, value;
+    is >> token; // Consume "name"
+
+    // Option names may contain spaces, read until "value"
+    while (is >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    while (is >> token) {
+        value += (value.empty() ? "" : " ") + token;
+    }
+
+    long long n;
+    if (name == "Threads") {
+        if (parseSpin(name, value, 1, MAX_THREADS, n)) {
+            Search::setThreadCount(static_cast<int>(n));
+        }
+    } else if (name == "Hash") {
+        if (parseSpin(name, value, 1, MAX_HASH_MB, n)
+            && !TT::tt.resize(static_cast<size_t>(n), Search::threadCount())) {
+            std::cout << "info string could not allocate " << n << " MB for the hash table, keeping "
+                      << TT::tt.sizeMB() << " MB" << std::endl;
+        }
+    } else if (name == "MultiPV") {
+        if (parseSpin(name, value, 1, MAX_MULTI_PV, n)) {
+            Search::setMultiPV(static_cast<int>(n));
+        }
+    } else if (name == "Ponder") {
+        ponderEnabled = (value == "true");
+    } else if (name == "Clear Hash") {
+        TT::tt.clear(Search::threadCount());
+    } else if (name == "EvalFile") {
+        if (value.empty() || value == "<empty>") {
+            return;
+        }
+        if (NNUE::load(value)) {
+            // Accumulators computed with the previous network are stale, and so are
+            // the cached evaluations (eval caches, TT eval field)
+            board.computeEvalTerms();
+            Search::clearEvalCaches();
+            TT::tt.clear(Search::threadCount());
+            std::cout << "info string NNUE network loaded from " << value << std::endl;
+        } else {
+            std::cout << "info string could not load NNUE network " << value << std::endl;
         }
-        moveStr += promoChar;
     }
-    
-    std::cout << "bestmove " << moveStr << std::endl;
+    // Silently ignore unknown options
 }
 
 void uciLoop() {
     Board board;
     board.initStartPosition(); // Initialize to starting position
-    std::string line, token;
+    std::string line;
 
     while (std::getline(std::cin, line)) {
         std::istringstream is(line);
+        std::string token;
         is >> token;
 
+        // Everything that reads or changes the position, the TT or the options waits
+        // for a running search to finish first
+        if (token != "stop" && token != "ponderhit" && token != "isready" && token != "quit") {
+            waitForSearch();
+        }
+
         if (token == "uci") {
             std::cout << "id name MagnusCarlsenMogger" << std::endl;
             std::cout << "id author CSE201_Team" << std::endl;
-            // No options for now
+            std::cout << "option name Threads type spin default 1 min 1 max " << MAX_THREADS << std::endl;
+            std::cout << "option name Hash type spin default " << TT::DEFAULT_SIZE_MB << " min 1 max " << MAX_HASH_MB << std::endl;
+            std::cout << "option name Clear Hash type button" << std::endl;
+            std::cout << "option name Ponder type check default false" << std::endl;
+            std::cout << "option name MultiPV type spin default 1 min 1 max " << MAX_MULTI_PV << std::endl;
+            std::cout << "option name EvalFile type string default <empty>" << std::endl;
             std::cout << "uciok" << std::endl;
         } 
         else if (token == "isready") {
-            std::cout << "readyok" << std::endl;
+            // Answered right away, also while searching
+            std::cout << "readyok\n" << std::flush;
         } 
+        else if (token == "stop") {
+            // The search thread prints the bestmove
+            Search::info.stopped = true;
+        }
+        else if (token == "ponderhit") {
+            // The opponent played the expected move: the search goes on as a normal
+            // timed search. On a miss the GUI sends "stop" and the ponder result is dropped
+            Search::ponderhit();
+        }
         else if (token == "ucinewgame") {
             board = Board();
             board.initStartPosition();
-            // Clear transposition table for new game
-            TT::tt.clear();
+            // Clear transposition table for new game (in parallel when we have several threads)
+            TT::tt.clear(Search::threadCount());
         } 
+        else if (token == "setoption") {
+            handleSetOption(board, is);
+        }
         else if (token == "position") {
             handlePosition(board, is);
         } 
         else if (token == "go") {
             handleGo(board, is);
         } 
+        else if (token == "ttstress") {
+            // Debug command: "ttstress [threads]" checks the TT for torn entries under concurrent access
+            std::vector<std::string> args;
+            while (is >> token) {
+                args.push_back(token);
+            }
+            runTTStress(args);
+        }
+        else if (token == "bench") {
+            // "bench [depth] [hash] [threads]": fixed position set, prints the node signature and NPS
+            std::vector<std::string> args;
+            while (is >> token) {
+                args.push_back(token);
+            }
+            int depth;
+            size_t hashMB;
+            int numThreads;
+            if (parseBenchArgs(args, depth, hashMB, numThreads)) {
+                Bench::run(depth, hashMB, numThreads, std::cout);
+            }
+        }
+        else if (token == "perft") {
+            // "perft <depth>": number of leaf nodes below the current position
+            int depth = 1;
+            is >> depth;
+            auto start = std::chrono::steady_clock::now();
+            uint64_t nodes = Perft::perft(board, depth);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "Nodes searched: " << nodes << ", time: " << std::fixed << std::setprecision(3)
+                      << seconds << " s, " << std::setprecision(2) << nodes / std::max(seconds, 1e-9) / 1e6
+                      << " MNPS" << std::defaultfloat << std::endl;
+        }
+        else if (token == "divide") {
+            // "divide <depth>": perft split by root move, to find which move a count differs on
+            int depth = 1;
+            is >> depth;
+            Perft::divide(board, depth, std::cout);
+        }
+        else if (token == "verifylegal") {
+            // Debug command: "verifylegal [depth]" compares the pin/check mask generator
+            // with the make/unmake legality filter on every node below the current position
+            int depth = 4;
+            is >> depth;
+            bool ok = MoveGenerator::verifyLegalGeneration(board, depth);
+            std::cout << "Legal move generation " << (ok ? "matches" : "DIFFERS from") << " the reference" << std::endl;
+        }
+        else if (token == "verifyeval") {
+            // Debug command: "verifyeval [depth]" checks the board's incremental eval terms and
+            // the EvalInfo attack maps against the from-scratch functions on every node below
+            // the current position
+            int depth = 4;
+            is >> depth;
+            bool ok = Evaluation::verifyEvalTerms(board, depth);
+            std::cout << "Incremental eval terms " << (ok ? "match" : "DIFFER from") << " the reference" << std::endl;
+        }
+        else if (token == "hashstats") {
+            // Debug command: depth / node type / age histograms over the whole TT
+            TT::tt.printStats(std::cout);
+        }
         else if (token == "quit") {
             break;
         }
         // Silently ignore unknown commands
     }
+
+    // "quit" or end of input: don't leave a search running
+    stopSearch();
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     // Initialize magic bitboards
     Magic::init();
     
@@ -243,8 +453,33 @@ int main() {
     // Initialize Zobrist hashing (required for TT)
     Zobrist::init();
     
-    // Clear transposition table
-    TT::tt.clear();
+    // Allocate transposition table (resized later by the "Hash" option)
+    TT::tt.resize(TT::DEFAULT_SIZE_MB);
+    
+    // "MagnusCarlsenMogger_UCI perft" runs the move generation regression suite and exits
+    // (used by the "perft" CMake target)
+    if (argc > 1 && std::string(argv[1]) == "perft") {
+        return Perft::runSuite(std::cout) ? 0 : 1;
+    }
+    
+    // "MagnusCarlsenMogger_UCI ttstress [threads]" runs the TT concurrency test and exits
+    // (used by the "ttstress" CMake target)
+    if (argc > 1 && std::string(argv[1]) == "ttstress") {
+        return runTTStress(std::vector<std::string>(argv + 2, argv + argc)) ? 0 : 1;
+    }
+    
+    // "MagnusCarlsenMogger_UCI bench [depth] [hash] [threads]" runs the benchmark and exits
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        int depth;
+        size_t hashMB;
+        int numThreads;
+        if (!parseBenchArgs(std::vector<std::string>(argv + 2, argv + argc), depth, hashMB, numThreads)) {
+            std::cerr << "usage: " << argv[0] << " bench [depth] [hash MB] [threads]\n";
+            return 1;
+        }
+        Bench::run(depth, hashMB, numThreads, std::cout);
+        return 0;
+    }
     
     // Disable output buffering for proper UCI communication
     std::cout.setf(std::ios::unitbuf);